@@ -0,0 +1,387 @@
+#pragma once
+/**
+ * @file fixed_pca.h
+ * @brief Principal Component Analysis for a number of variables known at compile time
+ */
+#include "pca.h"
+#include <array>
+
+namespace stats {
+/**
+ * @brief A class template for principal component analysis of a small number
+ * 	of variables known at compile time. Records are accumulated into running
+ * 	means and co-moments and all matrices are stored on the stack. Thus,
+ * 	neither adding records nor projecting records allocates memory
+ * @tparam N Number of variables
+ */
+template<long N>
+class fixed_pca {
+	static_assert(N>=2, "Number of variables smaller than two.");
+public:
+	/**
+	 * @brief The type of a record and of a vector in the space of principal components
+	 */
+	typedef std::array<double, N> record_type;
+	/**
+	 * @brief Constructor
+	 */
+	fixed_pca();
+	/**
+	 * @brief Returns the number of variables
+	 * @return The number of variables
+	 */
+	long get_num_variables() const;
+	/**
+	 * @brief Adds a data record by updating the running means and co-moments
+	 * @param record The record
+	 */
+	void add_record(const record_type& record);
+	/**
+	 * @brief Returns the number of records added
+	 * @return The number of records
+	 */
+	long get_num_records() const;
+	/**
+	 * @brief Sets whether to normalize each variable using the
+	 *  temporal standard deviation prior to solving the eigenproblem
+	 * @param do_normalize The boolean flag
+	 */
+	void set_do_normalize(bool do_normalize);
+	/**
+	 * @brief Returns whether the variables are normalized
+	 * @return The boolean flag
+	 */
+	bool get_do_normalize() const;
+	/**
+	 * @brief Solves the eigenproblem using a cyclic Jacobi method
+	 * @throws std::logic_error if the number of records is smaller than two
+	 * @throws std::runtime_error if the variables are to be normalized and one of the variables has zero variance
+	 */
+	void solve();
+	/**
+	 * @brief Sets the number of retained eigenvectors. This affects the
+	 *  projection from and to the space of principal components
+	 * @param num_retained The number of retained eigenvectors
+	 * @throws std::range_error if num_retained is out of range
+	 */
+	void set_num_retained(long num_retained);
+	/**
+	 * @brief Returns the number of retained eigenvectors
+	 * @return The number of retained eigenvectors
+	 */
+	long get_num_retained() const;
+	/**
+	 * @brief Projects a record in the variable space to a vector in the
+	 *  space of principal components. Components beyond the number of
+	 *  retained eigenvectors are zero
+	 * @param record The record
+	 * @return The vector in the space of principal components
+	 */
+	record_type to_principal_space(const record_type& record) const;
+	/**
+	 * @brief Projects a vector in the space of principal components
+	 *  to a record in the variable space
+	 * @param data The vector in the space of principal components
+	 * @return The record
+	 */
+	record_type to_variable_space(const record_type& data) const;
+	/**
+	 * @brief Returns the energy of the principal component analysis
+	 * @return The energy
+	 */
+	double get_energy() const;
+	/**
+	 * @brief Returns the eigen_index'th eigenvalue normalized by the energy
+	 * @param eigen_index The index starting at zero
+	 * @return An eigenvalue
+	 * @throws std::range_error if eigen_index is out of range
+	 */
+	double get_eigenvalue(long eigen_index) const;
+	/**
+	 * @brief Returns the eigenvalues normalized by the energy
+	 * @return The eigenvalues
+	 */
+	record_type get_eigenvalues() const;
+	/**
+	 * @brief Returns the eigen_index'th eigenvector
+	 * @param eigen_index The index starting at zero
+	 * @return The eigenvector
+	 * @throws std::range_error if eigen_index is out of range
+	 */
+	record_type get_eigenvector(long eigen_index) const;
+	/**
+	 * @brief Returns the mean values of the records added
+	 * @return The mean values
+	 */
+	record_type get_mean_values() const;
+	/**
+	 * @brief Returns the sigma values (standard deviation) of the records added
+	 * @return The sigma values
+	 */
+	record_type get_sigma_values() const;
+
+protected:
+
+	long num_records_;
+	bool do_normalize_;
+	long num_retained_;
+	double energy_;
+	typename arma::Col<double>::template fixed<N> mean_;
+	typename arma::Col<double>::template fixed<N> sigma_;
+	typename arma::Col<double>::template fixed<N> eigval_;
+	typename arma::Mat<double>::template fixed<N, N> comoment_;
+	typename arma::Mat<double>::template fixed<N, N> eigvec_;
+	void assert_index_(long eigen_index) const;
+};
+
+namespace utils {
+/**
+ * @brief Solves the eigenproblem of a small symmetric matrix of fixed size
+ * 	using the cyclic Jacobi method. Only the upper triangle of mat is used
+ * @param eigval The resulting eigenvalues in ascending order
+ * @param eigvec The resulting eigenvectors (column-wise)
+ * @param mat The symmetric matrix
+ */
+template<long N>
+void eig_sym_jacobi(typename arma::Col<double>::template fixed<N>& eigval,
+					typename arma::Mat<double>::template fixed<N, N>& eigvec,
+					const typename arma::Mat<double>::template fixed<N, N>& mat) {
+	double a[N][N];
+	double v[N][N];
+	double scale = 0;
+	for (long i=0; i<N; ++i) {
+		for (long j=0; j<N; ++j) {
+			a[i][j] = i<=j ? mat.at(i, j) : mat.at(j, i);
+			v[i][j] = i==j ? 1 : 0;
+			scale += a[i][j] * a[i][j];
+		}
+	}
+	const double tol = scale * 1e-30;
+	for (long sweep=0; sweep<50; ++sweep) {
+		double off = 0;
+		for (long p=0; p<N; ++p)
+			for (long q=p+1; q<N; ++q)
+				off += a[p][q] * a[p][q];
+		if (off<=tol) break;
+		for (long p=0; p<N; ++p) {
+			for (long q=p+1; q<N; ++q) {
+				if (a[p][q]==0) continue;
+				const double theta = (a[q][q] - a[p][p]) / (2 * a[p][q]);
+				const double t = (theta>=0 ? 1. : -1.) / (std::abs(theta) + std::sqrt(theta*theta + 1));
+				const double c = 1 / std::sqrt(t*t + 1);
+				const double s = t * c;
+				for (long k=0; k<N; ++k) {
+					const double akp = a[k][p];
+					const double akq = a[k][q];
+					a[k][p] = c*akp - s*akq;
+					a[k][q] = s*akp + c*akq;
+				}
+				for (long k=0; k<N; ++k) {
+					const double apk = a[p][k];
+					const double aqk = a[q][k];
+					a[p][k] = c*apk - s*aqk;
+					a[q][k] = s*apk + c*aqk;
+				}
+				for (long k=0; k<N; ++k) {
+					const double vkp = v[k][p];
+					const double vkq = v[k][q];
+					v[k][p] = c*vkp - s*vkq;
+					v[k][q] = s*vkp + c*vkq;
+				}
+			}
+		}
+	}
+	long order[N];
+	for (long i=0; i<N; ++i) order[i] = i;
+	std::sort(order, order+N, [&a](long i, long j) { return a[i][i] < a[j][j]; });
+	for (long i=0; i<N; ++i) {
+		eigval.at(i) = a[order[i]][order[i]];
+		for (long k=0; k<N; ++k)
+			eigvec.at(k, i) = v[k][order[i]];
+	}
+}
+
+} //utils
+
+template<long N>
+fixed_pca<N>::fixed_pca()
+	: num_records_(0),
+	  do_normalize_(false),
+	  num_retained_(N),
+	  energy_(0)
+{
+	mean_.zeros();
+	sigma_.zeros();
+	eigval_.zeros();
+	comoment_.zeros();
+	eigvec_.zeros();
+}
+
+template<long N>
+long fixed_pca<N>::get_num_variables() const {
+	return N;
+}
+
+template<long N>
+void fixed_pca<N>::add_record(const record_type& record) {
+	++num_records_;
+	double delta[N];
+	for (long i=0; i<N; ++i) {
+		delta[i] = record[i] - mean_.at(i);
+		mean_.at(i) += delta[i] / num_records_;
+	}
+	for (long j=0; j<N; ++j) {
+		const double residual = record[j] - mean_.at(j);
+		for (long i=0; i<=j; ++i)
+			comoment_.at(i, j) += delta[i] * residual;
+	}
+}
+
+template<long N>
+long fixed_pca<N>::get_num_records() const {
+	return num_records_;
+}
+
+template<long N>
+void fixed_pca<N>::set_do_normalize(bool do_normalize) {
+	do_normalize_ = do_normalize;
+}
+
+template<long N>
+bool fixed_pca<N>::get_do_normalize() const {
+	return do_normalize_;
+}
+
+template<long N>
+void fixed_pca<N>::solve() {
+	if (num_records_ < 2)
+		throw std::logic_error("Number of records smaller than two.");
+
+	typename arma::Mat<double>::template fixed<N, N> cov_mat;
+	for (long j=0; j<N; ++j)
+		for (long i=0; i<=j; ++i)
+			cov_mat.at(i, j) = comoment_.at(i, j) / (num_records_ - 1);
+
+	for (long i=0; i<N; ++i)
+		sigma_.at(i) = std::sqrt(cov_mat.at(i, i));
+
+	if (do_normalize_) {
+		for (long i=0; i<N; ++i)
+			if (sigma_.at(i)==0)
+				throw std::runtime_error("At least one of the entries of rms equals to zero");
+		for (long j=0; j<N; ++j)
+			for (long i=0; i<=j; ++i)
+				cov_mat.at(i, j) /= sigma_.at(i) * sigma_.at(j);
+	}
+
+	typename arma::Col<double>::template fixed<N> eigval;
+	typename arma::Mat<double>::template fixed<N, N> eigvec;
+	utils::eig_sym_jacobi<N>(eigval, eigvec, cov_mat);
+
+	for (long i=0; i<N; ++i) {
+		eigval_.at(i) = eigval.at(N-1-i);
+		for (long k=0; k<N; ++k)
+			eigvec_.at(k, i) = eigvec.at(k, N-1-i);
+	}
+
+	utils::enforce_positive_sign_by_column(eigvec_);
+
+	energy_ = 0;
+	for (long i=0; i<N; ++i)
+		energy_ += eigval_.at(i);
+	for (long i=0; i<N; ++i)
+		eigval_.at(i) /= energy_;
+}
+
+template<long N>
+void fixed_pca<N>::set_num_retained(long num_retained) {
+	if (num_retained<=0 || num_retained>N)
+		throw std::range_error(utils::join("Value out of range: ", num_retained));
+	num_retained_ = num_retained;
+}
+
+template<long N>
+long fixed_pca<N>::get_num_retained() const {
+	return num_retained_;
+}
+
+template<long N>
+inline typename fixed_pca<N>::record_type fixed_pca<N>::to_principal_space(const record_type& record) const {
+	double centered[N];
+	for (long j=0; j<N; ++j) {
+		centered[j] = record[j] - mean_.at(j);
+		if (do_normalize_) centered[j] /= sigma_.at(j);
+	}
+	record_type result;
+	for (long i=0; i<N; ++i) {
+		double value = 0;
+		if (i<num_retained_) {
+			const double* column = eigvec_.colptr(i);
+			for (long j=0; j<N; ++j)
+				value += column[j] * centered[j];
+		}
+		result[i] = value;
+	}
+	return result;
+}
+
+template<long N>
+inline typename fixed_pca<N>::record_type fixed_pca<N>::to_variable_space(const record_type& data) const {
+	record_type result;
+	for (long j=0; j<N; ++j) {
+		double value = 0;
+		for (long i=0; i<num_retained_; ++i)
+			value += eigvec_.at(j, i) * data[i];
+		if (do_normalize_) value *= sigma_.at(j);
+		result[j] = value + mean_.at(j);
+	}
+	return result;
+}
+
+template<long N>
+double fixed_pca<N>::get_energy() const {
+	return energy_;
+}
+
+template<long N>
+void fixed_pca<N>::assert_index_(long eigen_index) const {
+	if (eigen_index<0 || eigen_index>=N)
+		throw std::range_error(utils::join("Index out of range: ", eigen_index));
+}
+
+template<long N>
+double fixed_pca<N>::get_eigenvalue(long eigen_index) const {
+	assert_index_(eigen_index);
+	return eigval_.at(eigen_index);
+}
+
+template<long N>
+typename fixed_pca<N>::record_type fixed_pca<N>::get_eigenvalues() const {
+	record_type result;
+	std::copy(eigval_.memptr(), eigval_.memptr() + N, result.begin());
+	return result;
+}
+
+template<long N>
+typename fixed_pca<N>::record_type fixed_pca<N>::get_eigenvector(long eigen_index) const {
+	assert_index_(eigen_index);
+	record_type result;
+	std::copy(eigvec_.colptr(eigen_index), eigvec_.colptr(eigen_index) + N, result.begin());
+	return result;
+}
+
+template<long N>
+typename fixed_pca<N>::record_type fixed_pca<N>::get_mean_values() const {
+	record_type result;
+	std::copy(mean_.memptr(), mean_.memptr() + N, result.begin());
+	return result;
+}
+
+template<long N>
+typename fixed_pca<N>::record_type fixed_pca<N>::get_sigma_values() const {
+	record_type result;
+	std::copy(sigma_.memptr(), sigma_.memptr() + N, result.begin());
+	return result;
+}
+
+} //stats
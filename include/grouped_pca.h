@@ -0,0 +1,241 @@
+#pragma once
+/**
+ * @file grouped_pca.h
+ * @brief Principal component analysis per group of keyed records
+ */
+#include "pca_batch.h"
+#include <unordered_map>
+#include <functional>
+
+namespace stats {
+/**
+ * @brief A class template computing one principal component analysis per
+ * 	key from keyed records in a single pass. Each key is mapped via a hash
+ * 	table to a model of a basic_pca_batch which keeps the running moments
+ * 	of all groups in one contiguous arena and solves all groups in parallel
+ * @tparam Key The key type
+ * @tparam T The element type. Supported are float and double
+ * @tparam Hash The hash function of the keys
+ */
+template<typename Key, typename T=double, typename Hash=std::hash<Key>>
+class grouped_pca {
+public:
+	/**
+	 * @brief The key type
+	 */
+	typedef Key key_type;
+	/**
+	 * @brief The element type
+	 */
+	typedef T value_type;
+	/**
+	 * @brief Constructor
+	 * @param num_vars Number of variables of every group
+	 * @throws std::invalid_argument if num_vars is smaller than two
+	 */
+	explicit grouped_pca(long num_vars)
+		: num_vars_(num_vars)
+	{
+		if (num_vars_ < 2)
+			throw std::invalid_argument("Number of variables smaller than two.");
+	}
+	/**
+	 * @brief Returns the number of variables of every group
+	 * @return The number of variables
+	 */
+	long get_num_variables() const {
+		return num_vars_;
+	}
+	/**
+	 * @brief Adds a data record to the group of key. Creates the group
+	 * 	if it does not exist yet
+	 * @param key The key
+	 * @param record A vector with a size that equals the number of variables
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 */
+	void add_record(const Key& key, const std::vector<T>& record) {
+		if (num_vars_ != long(record.size()))
+			throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+		auto iter = groups_.find(key);
+		if (iter==groups_.end()) {
+			iter = groups_.insert(std::make_pair(key, batch_.add_model(num_vars_))).first;
+			keys_.push_back(key);
+		}
+		batch_.add_record(iter->second, record);
+	}
+	/**
+	 * @brief Returns the number of groups
+	 * @return The number of groups
+	 */
+	long get_num_groups() const {
+		return keys_.size();
+	}
+	/**
+	 * @brief Returns the keys of all groups in order of their first record
+	 * @return The keys
+	 */
+	const std::vector<Key>& get_keys() const {
+		return keys_;
+	}
+	/**
+	 * @brief Returns whether a group exists for key
+	 * @param key The key
+	 * @return The boolean flag
+	 */
+	bool has_group(const Key& key) const {
+		return groups_.find(key)!=groups_.end();
+	}
+	/**
+	 * @brief Returns the number of records of the group of key
+	 * @param key The key
+	 * @return The number of records
+	 * @throws std::domain_error if there is no group for key
+	 */
+	long get_num_records(const Key& key) const {
+		return batch_.get_num_records(get_model_(key));
+	}
+	/**
+	 * @brief Sets whether to normalize each variable using the
+	 *  temporal standard deviation prior to solving the eigenproblems
+	 * @param do_normalize The boolean flag
+	 */
+	void set_do_normalize(bool do_normalize) {
+		batch_.set_do_normalize(do_normalize);
+	}
+	/**
+	 * @brief Returns whether the variables are normalized
+	 * @return The boolean flag
+	 */
+	bool get_do_normalize() const {
+		return batch_.get_do_normalize();
+	}
+	/**
+	 * @brief Sets the algorithmic solver to be used to solve the eigenproblems
+	 * @param solver Available options: 'standard', 'dc' and 'packed' where
+	 *  packed solves the upper triangle of each covariance matrix without
+	 *  forming the full matrix. Default is dc
+	 * @throws std::invalid_argument if solver is not equal to 'standard', 'dc' or 'packed'
+	 */
+	void set_solver(const std::string& solver) {
+		batch_.set_solver(solver);
+	}
+	/**
+	 * @brief Sets the number of threads used to solve the groups
+	 * @param num_threads The number of threads
+	 * @throws std::invalid_argument if num_threads is smaller than one
+	 */
+	void set_num_threads(long num_threads) {
+		batch_.set_num_threads(num_threads);
+	}
+	/**
+	 * @brief Sets the thread pool used to solve the groups. An empty
+	 * 	pointer selects the default thread pool
+	 * @param pool The thread pool
+	 */
+	void set_thread_pool(const std::shared_ptr<thread_pool>& pool) {
+		batch_.set_thread_pool(pool);
+	}
+	/**
+	 * @brief Solves the eigenproblems of all groups in parallel
+	 * @throws std::logic_error if a group has less than two records
+	 * @throws std::runtime_error if the variables are to be normalized and
+	 * 	one of the variables of a group has zero variance
+	 */
+	void solve() {
+		batch_.solve();
+	}
+	/**
+	 * @brief Returns the energy of the group of key
+	 * @param key The key
+	 * @return The energy
+	 * @throws std::domain_error if there is no group for key
+	 */
+	T get_energy(const Key& key) const {
+		return batch_.get_energy(get_model_(key));
+	}
+	/**
+	 * @brief Returns the eigenvalues of the group of key normalized by their sum
+	 * @param key The key
+	 * @return The eigenvalues
+	 * @throws std::domain_error if there is no group for key
+	 */
+	std::vector<T> get_eigenvalues(const Key& key) const {
+		return batch_.get_eigenvalues(get_model_(key));
+	}
+	/**
+	 * @brief Returns the eigen_index'th eigenvector of the group of key
+	 * @param key The key
+	 * @param eigen_index The index corresponding to the eigen_index'th
+	 *  eigenvalue starting at zero
+	 * @return The eigenvector
+	 * @throws std::domain_error if there is no group for key
+	 * @throws std::range_error if eigen_index is out of range
+	 */
+	std::vector<T> get_eigenvector(const Key& key, long eigen_index) const {
+		return batch_.get_eigenvector(get_model_(key), eigen_index);
+	}
+	/**
+	 * @brief Returns the mean values of the group of key
+	 * @param key The key
+	 * @return The mean values
+	 * @throws std::domain_error if there is no group for key
+	 */
+	std::vector<T> get_mean_values(const Key& key) const {
+		return batch_.get_mean_values(get_model_(key));
+	}
+	/**
+	 * @brief Returns the sigma values of the group of key
+	 * @param key The key
+	 * @return The sigma values
+	 * @throws std::domain_error if there is no group for key
+	 */
+	std::vector<T> get_sigma_values(const Key& key) const {
+		return batch_.get_sigma_values(get_model_(key));
+	}
+	/**
+	 * @brief Projects a record to the space of principal components of the group of key
+	 * @param key The key
+	 * @param record A vector with a size that equals the number of variables
+	 * @return A vector with a size that equals the number of variables
+	 * @throws std::domain_error if there is no group for key or if record's
+	 * 	size is not equal to the number of variables
+	 */
+	std::vector<T> to_principal_space(const Key& key, const std::vector<T>& record) const {
+		return batch_.to_principal_space(get_model_(key), record);
+	}
+	/**
+	 * @brief Projects a vector in the space of principal components of the
+	 * 	group of key to a record in the variable space
+	 * @param key The key
+	 * @param data A vector with a size that equals the number of variables
+	 * @return A vector with a size that equals the number of variables
+	 * @throws std::domain_error if there is no group for key or if data's
+	 * 	size is not equal to the number of variables
+	 */
+	std::vector<T> to_variable_space(const Key& key, const std::vector<T>& data) const {
+		return batch_.to_variable_space(get_model_(key), data);
+	}
+	/**
+	 * @brief Returns the underlying batch whose model indices follow get_keys
+	 * @return The batch
+	 */
+	const basic_pca_batch<T>& get_batch() const {
+		return batch_;
+	}
+
+protected:
+
+	long num_vars_;
+	basic_pca_batch<T> batch_;
+	std::unordered_map<Key, long, Hash> groups_;
+	std::vector<Key> keys_;
+
+	long get_model_(const Key& key) const {
+		const auto iter = groups_.find(key);
+		if (iter==groups_.end())
+			throw std::domain_error("No such group available.");
+		return iter->second;
+	}
+};
+
+} //stats
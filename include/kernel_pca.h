@@ -0,0 +1,251 @@
+#pragma once
+/**
+ * @file kernel_pca.h
+ * @brief Kernel principal component analysis using the Nystroem approximation
+ */
+#include "pca.h"
+
+namespace stats {
+/**
+ * @brief A class template for kernel principal component analysis. The
+ * 	kernel matrix is approximated from m randomly sampled landmark records
+ * 	(Nystroem method): each record x is mapped to the features
+ * 	Lambda^{-1/2} U^T k(landmarks, x) where U Lambda U^T is the eigen
+ * 	decomposition of the landmark kernel matrix. A linear principal
+ * 	component analysis of the centered features then costs O(n m^2)
+ * 	instead of O(n^3) for the exact n x n kernel matrix
+ * @tparam T The element type of records and results. Supported are float
+ * 	and double. All kernel computations are done in double precision
+ */
+template<typename T>
+class basic_kernel_pca {
+public:
+	/**
+	 * @brief The element type
+	 */
+	typedef T value_type;
+	/**
+	 * @brief Constructor
+	 */
+	basic_kernel_pca();
+	/**
+	 * @brief Constructor
+	 * @param num_vars Number of variables
+	 * @throws std::invalid_argument if num_vars is smaller than one
+	 */
+	explicit basic_kernel_pca(long num_vars);
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~basic_kernel_pca();
+	/**
+	 * @brief Sets the number of variables. Removes all records
+	 * @param num_vars Number of variables
+	 * @throws std::invalid_argument if num_vars is smaller than one
+	 */
+	void set_num_variables(long num_vars);
+	/**
+	 * @brief Returns the number of variables
+	 * @return The number of variables
+	 */
+	long get_num_variables() const;
+	/**
+	 * @brief Adds a data record
+	 * @param record A vector with a size that equals the number of variables
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 *  or if one of its values is not finite. Missing values are not supported
+	 */
+	void add_record(const std::vector<T>& record);
+	/**
+	 * @brief Returns the previously added record with index record_index
+	 * @param record_index The record index
+	 * @return The record
+	 */
+	std::vector<T> get_record(long record_index) const;
+	/**
+	 * @brief Returns the number of records
+	 * @return The number of records
+	 */
+	long get_num_records() const;
+	/**
+	 * @brief Sets the kernel function
+	 * @param kernel Available options: 'rbf' for exp(-gamma |x - y|^2) and
+	 * 	'polynomial' for (gamma x^T y + coef0)^degree. Default is rbf
+	 * @throws std::invalid_argument if kernel is not equal to 'rbf' or 'polynomial'
+	 */
+	void set_kernel(const std::string& kernel);
+	/**
+	 * @brief Returns the kernel function
+	 * @return The kernel function
+	 */
+	std::string get_kernel() const;
+	/**
+	 * @brief Sets the parameter gamma of the kernel function
+	 * @param gamma The parameter. Zero selects one over the number of variables
+	 * 	which is the default
+	 * @throws std::invalid_argument if gamma is negative
+	 */
+	void set_gamma(double gamma);
+	/**
+	 * @brief Returns the parameter gamma of the kernel function
+	 * @return The parameter
+	 */
+	double get_gamma() const;
+	/**
+	 * @brief Sets the degree of the polynomial kernel
+	 * @param degree The degree. Default is three
+	 * @throws std::invalid_argument if degree is smaller than one
+	 */
+	void set_degree(long degree);
+	/**
+	 * @brief Returns the degree of the polynomial kernel
+	 * @return The degree
+	 */
+	long get_degree() const;
+	/**
+	 * @brief Sets the constant term of the polynomial kernel
+	 * @param coef0 The constant term. Default is one
+	 */
+	void set_coef0(double coef0);
+	/**
+	 * @brief Returns the constant term of the polynomial kernel
+	 * @return The constant term
+	 */
+	double get_coef0() const;
+	/**
+	 * @brief Sets the number of landmark records sampled for the Nystroem
+	 * 	approximation. All records are used if there are fewer
+	 * @param num_landmarks The number of landmarks. Default is 100
+	 * @param seed The random seed used to sample the landmarks
+	 * @throws std::invalid_argument if num_landmarks is smaller than two
+	 */
+	void set_num_landmarks(long num_landmarks, long seed=1);
+	/**
+	 * @brief Returns the number of landmark records
+	 * @return The number of landmarks
+	 */
+	long get_num_landmarks() const;
+	/**
+	 * @brief Sets the number of threads used by this instance. Creates
+	 *  a thread pool owned by this instance (and its copies)
+	 * @param num_threads The number of threads
+	 * @throws std::invalid_argument if num_threads is smaller than one
+	 */
+	void set_num_threads(long num_threads);
+	/**
+	 * @brief Sets the thread pool used by this instance. An empty pointer
+	 *  selects the pool of the calling thread
+	 * @param pool The thread pool
+	 */
+	void set_thread_pool(const std::shared_ptr<thread_pool>& pool);
+	/**
+	 * @brief Returns the thread pool used by this instance
+	 * @return The thread pool
+	 */
+	std::shared_ptr<thread_pool> get_thread_pool() const;
+	/**
+	 * @brief Solves the eigenproblem of the approximated kernel matrix.
+	 * 	Retains all components afterwards
+	 * @throws std::invalid_argument if the number of variables is smaller than one
+	 * @throws std::logic_error if the number of records is smaller than two
+	 * @throws std::runtime_error if the landmark kernel matrix is zero
+	 */
+	void solve();
+	/**
+	 * @brief Sets the number of retained components. This affects the
+	 *  projection to the space of principal components
+	 * @param num_retained The number of retained components
+	 * @throws std::range_error if num_retained is out of range
+	 */
+	void set_num_retained(long num_retained);
+	/**
+	 * @brief Returns the number of retained components
+	 * @return The number of retained components
+	 */
+	long get_num_retained() const;
+	/**
+	 * @brief Returns the number of components which is the rank of the
+	 * 	landmark kernel matrix
+	 * @return The number of components
+	 */
+	long get_num_components() const;
+	/**
+	 * @brief Returns the energy which is the sum of the eigenvalues
+	 * @return The energy
+	 */
+	T get_energy() const;
+	/**
+	 * @brief Returns the eigen_index'th eigenvalue starting at zero
+	 * 	normalized by the energy
+	 * @param eigen_index The index of the eigenvalue
+	 * @return An eigenvalue
+	 * @throws std::range_error if eigen_index is out of range
+	 */
+	T get_eigenvalue(long eigen_index) const;
+	/**
+	 * @brief Returns the eigenvalues normalized by the energy
+	 * @return The eigenvalues
+	 */
+	std::vector<T> get_eigenvalues() const;
+	/**
+	 * @brief Returns the eigen_index'th principal component of the records
+	 * @param eigen_index The index of the component
+	 * @return The principal component with a size that equals the number of records
+	 * @throws std::range_error if eigen_index is out of range
+	 */
+	std::vector<T> get_principal(long eigen_index) const;
+	/**
+	 * @brief Projects a record to the space of principal components
+	 * @param record A vector with a size that equals the number of variables
+	 * @return A vector with a size that equals the number of retained components
+	 * @throws std::logic_error if solve has not been called
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 */
+	std::vector<T> to_principal_space(const std::vector<T>& record) const;
+	/**
+	 * @brief Projects several records to the space of principal components
+	 *  using the thread pool of this instance
+	 * @param records Vectors with a size that equals the number of variables
+	 * @return Vectors with a size that equals the number of retained components
+	 * @throws std::logic_error if solve has not been called
+	 * @throws std::domain_error if one of the records' sizes is not equal to the number of variables
+	 */
+	std::vector<std::vector<T>> to_principal_space(const std::vector<std::vector<T>>& records) const;
+
+protected:
+
+	long num_vars_;
+	long num_records_;
+	long record_buffer_;
+	std::string kernel_;
+	double gamma_;
+	long degree_;
+	double coef0_;
+	long num_landmarks_;
+	long landmark_seed_;
+	long num_retained_;
+	double energy_;
+	arma::Mat<T> data_;
+	arma::Mat<double> landmarks_;
+	arma::Mat<double> feature_map_;
+	arma::Col<double> feature_mean_;
+	arma::Col<double> eigval_;
+	arma::Mat<double> eigvec_;
+	arma::Mat<T> princomp_;
+	std::shared_ptr<thread_pool> thread_pool_;
+	void assert_num_vars_() const;
+	void assert_solved_() const;
+	void resize_data_if_needed_();
+	arma::Mat<double> make_kernel_matrix_(const arma::Mat<double>& records) const;
+	arma::Mat<double> make_features_(const arma::Mat<double>& records) const;
+};
+/**
+ * @brief Kernel principal component analysis in double precision
+ */
+typedef basic_kernel_pca<double> kernel_pca;
+/**
+ * @brief Kernel principal component analysis in single precision
+ */
+typedef basic_kernel_pca<float> fkernel_pca;
+
+} //stats
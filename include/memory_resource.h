@@ -0,0 +1,167 @@
+#pragma once
+/**
+ * @file memory_resource.h
+ * @brief Memory resources for the large buffers of libpca
+ */
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace stats {
+/**
+ * @brief The default alignment of memory blocks which suits the
+ * 	vectorized kernels
+ */
+const std::size_t memory_block_alignment = 64;
+/**
+ * @brief An interface for memory resources modelled on
+ * 	std::pmr::memory_resource. Derived classes implement do_allocate,
+ * 	do_deallocate and optionally do_is_equal. Implementations must be
+ * 	thread-safe if the resource is shared by instances used on several threads
+ */
+class memory_resource {
+public:
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~memory_resource();
+	/**
+	 * @brief Allocates a block of memory
+	 * @param bytes The size of the block
+	 * @param alignment The alignment of the block, a power of two
+	 * @return The block
+	 * @throws std::bad_alloc if the block cannot be allocated
+	 */
+	void* allocate(std::size_t bytes, std::size_t alignment=memory_block_alignment);
+	/**
+	 * @brief Deallocates a block allocated by this resource
+	 * @param memory The block
+	 * @param bytes The size the block was allocated with
+	 * @param alignment The alignment the block was allocated with
+	 */
+	void deallocate(void* memory, std::size_t bytes, std::size_t alignment=memory_block_alignment);
+	/**
+	 * @brief Returns whether memory allocated by this resource can be
+	 * 	deallocated by the other resource and vice versa
+	 * @param other The other resource
+	 * @return The boolean flag
+	 */
+	bool is_equal(const memory_resource& other) const;
+	/**
+	 * @brief Returns the default resource which allocates from the global heap
+	 * @return The default resource
+	 */
+	static std::shared_ptr<memory_resource> get_default();
+
+protected:
+	virtual void* do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+	virtual void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) = 0;
+	virtual bool do_is_equal(const memory_resource& other) const;
+};
+/**
+ * @brief A monotonic arena. Blocks are carved from chunks obtained from an
+ * 	upstream resource, deallocate does nothing and release returns all
+ * 	chunks at once. This co-locates the buffers of a model and reclaims
+ * 	them in one shot. Thread-safe
+ */
+class arena_resource : public memory_resource {
+public:
+	/**
+	 * @brief Constructor
+	 * @param chunk_bytes The minimum size of the chunks requested from upstream
+	 * @param upstream The upstream resource. An empty pointer selects the default resource
+	 */
+	explicit arena_resource(std::size_t chunk_bytes=1L << 24,
+							const std::shared_ptr<memory_resource>& upstream=std::shared_ptr<memory_resource>());
+	/**
+	 * @brief Destructor. Releases all chunks
+	 */
+	~arena_resource();
+	arena_resource(const arena_resource&) = delete;
+	arena_resource& operator=(const arena_resource&) = delete;
+	/**
+	 * @brief Returns all chunks to the upstream resource. Blocks handed out
+	 * 	before become invalid, so instances using the arena must be
+	 * 	destroyed or moved to another resource beforehand
+	 */
+	void release();
+	/**
+	 * @brief Returns the number of bytes handed out since the last release
+	 * @return The number of bytes
+	 */
+	std::size_t get_bytes_allocated() const;
+	/**
+	 * @brief Returns the number of bytes obtained from upstream
+	 * @return The number of bytes
+	 */
+	std::size_t get_bytes_reserved() const;
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment);
+	void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment);
+
+private:
+	struct chunk {
+		char* memory;
+		std::size_t bytes;
+	};
+	std::size_t chunk_bytes_;
+	std::shared_ptr<memory_resource> upstream_;
+	std::vector<chunk> chunks_;
+	std::size_t offset_;
+	std::size_t bytes_allocated_;
+	std::size_t bytes_reserved_;
+	mutable std::mutex mutex_;
+};
+/**
+ * @brief A block of memory owned together with the resource it was
+ * 	allocated from. Used by the matrices of basic_pca which copy their
+ * 	elements themselves: a copy is empty and copy assignment keeps the
+ * 	block of the target. Moves transfer the block
+ */
+class memory_block {
+public:
+	/**
+	 * @brief Constructor of an empty block
+	 */
+	memory_block();
+	/**
+	 * @brief Constructor
+	 * @param resource The resource to allocate from
+	 * @param bytes The size of the block
+	 * @param alignment The alignment of the block
+	 */
+	memory_block(const std::shared_ptr<memory_resource>& resource, std::size_t bytes,
+				 std::size_t alignment=memory_block_alignment);
+	/**
+	 * @brief Destructor. Returns the block to its resource
+	 */
+	~memory_block();
+	memory_block(const memory_block& other);
+	memory_block(memory_block&& other);
+	memory_block& operator=(const memory_block& other);
+	memory_block& operator=(memory_block&& other);
+	/**
+	 * @brief Returns the memory of the block
+	 * @return The memory or a null pointer if the block is empty
+	 */
+	void* get() const;
+	/**
+	 * @brief Returns the size of the block
+	 * @return The number of bytes
+	 */
+	std::size_t size() const;
+	/**
+	 * @brief Returns the block to its resource
+	 */
+	void reset();
+
+private:
+	std::shared_ptr<memory_resource> resource_;
+	void* memory_;
+	std::size_t bytes_;
+	std::size_t alignment_;
+};
+
+} //stats
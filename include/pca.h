@@ -6,30 +6,188 @@
 #include <vector>
 #include <string>
 #include <sstream>
+#include <memory>
+#include <atomic>
+#include <random>
+#include <functional>
+#include <stdexcept>
+#include <chrono>
+#include <cstdint>
 #include <armadillo>
+#include "thread_pool.h"
+#include "record_buffer.h"
+#include "memory_resource.h"
 /**
  * @brief A namespace for statistical analysis
  */
 namespace stats {
 /**
- * @brief A class for principal component analysis
+ * @brief An immutable snapshot of the state needed to project records to
+ * 	and from the space of principal components
+ * @tparam T The element type
  */
-class pca {
+template<typename T>
+struct pca_model {
+	/**
+	 * @brief The retained eigenvectors (column-wise)
+	 */
+	arma::Mat<T> eigvec;
+	/**
+	 * @brief The mean values of the variables
+	 */
+	arma::Col<T> mean;
+	/**
+	 * @brief The sigma values of the variables
+	 */
+	arma::Col<T> sigma;
+	/**
+	 * @brief Whether the variables are normalized
+	 */
+	bool do_normalize;
+};
+/**
+ * @brief A read-only view of a vector stored inside another object. The
+ * 	elements are not copied, so the view is only valid as long as the
+ * 	storage it refers to is neither modified nor reallocated
+ * @tparam T The element type
+ */
+template<typename T>
+class vector_view {
+public:
+	/**
+	 * @brief Constructor
+	 * @param data The first element
+	 * @param size The number of elements
+	 * @param stride The distance between consecutive elements
+	 */
+	vector_view(const T* data, long size, long stride=1)
+		: data_(data), size_(size), stride_(stride)
+	{}
+	/**
+	 * @brief Returns the first element
+	 * @return The pointer to the first element
+	 */
+	const T* data() const {
+		return data_;
+	}
+	/**
+	 * @brief Returns the number of elements
+	 * @return The number of elements
+	 */
+	long size() const {
+		return size_;
+	}
+	/**
+	 * @brief Returns the distance between consecutive elements
+	 * @return The stride
+	 */
+	long stride() const {
+		return stride_;
+	}
+	/**
+	 * @brief Returns the index'th element without range check
+	 * @param index The index
+	 * @return The element
+	 */
+	const T& operator[](long index) const {
+		return data_[index * stride_];
+	}
+	/**
+	 * @brief Copies the elements to a vector
+	 * @return The vector
+	 */
+	std::vector<T> to_vector() const {
+		std::vector<T> result(size_);
+		for (long i=0; i<size_; ++i)
+			result[i] = data_[i * stride_];
+		return std::move(result);
+	}
+
+private:
+	const T* data_;
+	long size_;
+	long stride_;
+};
+/**
+ * @brief A token used to cancel a running solve. Copies share their state
+ */
+class cancellation_token {
+public:
+	/**
+	 * @brief Constructor
+	 */
+	cancellation_token()
+		: cancelled_(std::make_shared<std::atomic<bool>>(false))
+	{}
+	/**
+	 * @brief Requests cancellation. This function is thread-safe
+	 */
+	void cancel() {
+		cancelled_->store(true);
+	}
+	/**
+	 * @brief Returns whether cancellation was requested
+	 * @return The boolean flag
+	 */
+	bool is_cancelled() const {
+		return cancelled_->load();
+	}
+	/**
+	 * @brief Withdraws a cancellation request
+	 */
+	void reset() {
+		cancelled_->store(false);
+	}
+
+private:
+	std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+/**
+ * @brief The exception thrown by a solve that was cancelled
+ */
+class solve_cancelled : public std::runtime_error {
 public:
 	/**
 	 * @brief Constructor
 	 */
-	pca();
+	solve_cancelled()
+		: std::runtime_error("Solve cancelled.")
+	{}
+};
+/**
+ * @brief The function called to report the progress of a solve. Its
+ * 	arguments are the stage ('statistics', 'covariance', 'eigensolve',
+ * 	'imputation' or 'bootstrap'), the fraction of the stage done and the index of the
+ * 	bootstrap replicate just completed (-1 outside of bootstrapping)
+ */
+typedef std::function<void(const std::string& stage, double fraction, long replicate)> progress_callback;
+/**
+ * @brief A class template for principal component analysis
+ * @tparam T The element type used to store records, eigenvectors and
+ * 	principal components. Supported are float and double. The covariance
+ * 	matrix is always accumulated and solved in double precision
+ */
+template<typename T>
+class basic_pca {
+public:
+	/**
+	 * @brief The element type
+	 */
+	typedef T value_type;
+	/**
+	 * @brief Constructor
+	 */
+	basic_pca();
 	/**
 	 * @brief Constructor
 	 * @param num_vars Number of variables
 	 * @throws std::invalid_argument if num_vars is smaller than two
 	 */
-	explicit pca(long num_vars);
+	explicit basic_pca(long num_vars);
 	/**
 	 * @brief Destructor
 	 */
-	virtual ~pca();
+	virtual ~basic_pca();
 	/**
 	 * @brief Comparison operator. Two pca instances are considered equal if
 	 * 	all private members (minus the added data records) are equal relative
@@ -37,7 +195,7 @@ public:
 	 * @param other Another instance of pca
 	 * @return Whether two pca instances can be considered equal
 	 */
-	bool operator==(const pca& other);
+	bool operator==(const basic_pca& other);
 	/**
 	 * @brief Sets the number of variables
 	 * @param num_vars Number of variables
@@ -50,23 +208,88 @@ public:
 	 */
 	long get_num_variables() const;
 	/**
-	 * @brief Adds a data record to pca
+	 * @brief Adds a data record to pca. This function is thread-safe if
+	 *  concurrent ingestion is enabled. Missing values are given as NaN
+	 *  and are marked in a bitmask of the record (see is_missing)
 	 * @param record A vector with a size that equals the number
 	 *  of variables assigned to pca
 	 * @throws std::domain_error if record's size is not equal to the number of variables
 	 */
-	void add_record(const std::vector<double>& record);
+	void add_record(const std::vector<T>& record);
+	/**
+	 * @brief Adds a weighted data record to pca. The weight acts as a
+	 *  frequency: the record contributes to the means, sigmas and the
+	 *  covariance matrix like weight copies of it. This function is
+	 *  thread-safe if concurrent ingestion is enabled
+	 * @param record A vector with a size that equals the number
+	 *  of variables assigned to pca
+	 * @param weight The weight of the record
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 * @throws std::invalid_argument if weight is not positive
+	 */
+	void add_record(const std::vector<T>& record, double weight);
+	/**
+	 * @brief Sets whether add_record may be called from several threads at
+	 *  once. Records are then collected in per-thread buffers and moved to
+	 *  the data matrix by flush_records. Records of the same thread keep
+	 *  their order. Do not change this flag while records are added
+	 * @param do_concurrent_ingestion The boolean flag
+	 */
+	void set_do_concurrent_ingestion(bool do_concurrent_ingestion);
+	/**
+	 * @brief Returns whether add_record may be called from several threads at once
+	 * @return The boolean flag
+	 */
+	bool get_do_concurrent_ingestion() const;
+	/**
+	 * @brief Moves the records added concurrently so far to the data matrix.
+	 *  Afterwards they are counted by get_num_records and returned by
+	 *  get_record. solve calls this function. Must not be called from
+	 *  several threads at once but add_record may run concurrently
+	 */
+	void flush_records();
 	/**
-	 * @brief Returns the previously added record with index record_index
+	 * @brief Returns the previously added record with index record_index.
+	 *  solve leaves the records as they were added
 	 * @param record_index The record index
 	 * @return The record
 	 */
-	std::vector<double> get_record(long record_index) const;
+	std::vector<T> get_record(long record_index) const;
+	/**
+	 * @brief Returns a view of the previously added record with index
+	 *  record_index without copying it. The stride equals the capacity of
+	 *  the data matrix. The view is invalidated by adding records, solve,
+	 *  load and set_num_variables
+	 * @param record_index The record index
+	 * @return The view of the record
+	 * @throws std:range_error if record_index is out of range
+	 */
+	vector_view<T> view_record(long record_index) const;
 	/**
 	 * @brief Returns the number of records assigned to pca
 	 * @return The number of records
 	 */
 	long get_num_records() const;
+	/**
+	 * @brief Returns the sum of the weights of the records assigned to pca
+	 *  which equals the number of records if no weights were given
+	 * @return The total weight
+	 */
+	double get_total_weight() const;
+	/**
+	 * @brief Returns the number of missing values among the records
+	 *  assigned to pca
+	 * @return The number of missing values
+	 */
+	long get_num_missing() const;
+	/**
+	 * @brief Returns whether a value of a previously added record is missing
+	 * @param record_index The record index
+	 * @param var_index The variable index
+	 * @return Whether the value is missing
+	 * @throws std::range_error if record_index or var_index is out of range
+	 */
+	bool is_missing(long record_index, long var_index) const;
 	/**
 	 * @brief Sets whether to normalize each variable using the
 	 *  temporal standard deviation prior to solving the eigenproblem
@@ -106,10 +329,30 @@ public:
 	long get_bootstrap_seed() const;
 	/**
 	 * @brief Sets the algorithmic solver to be used to solve the eigenproblem
-	 * @param solver Available options: 'standard' and 'dc' where dc (divide
+	 * @param solver Available options: 'standard', 'dc', 'mixed', 'em', 'tsqr', 'svd', 'packed' and 'auto' where dc (divide
 	 *  and conquer) is significantly faster but may result in slightly
-	 *  different eigenvalues. Default is dc
-	 * @throws std::invalid_argument if solver is not equal to 'standard' or 'dc'
+	 *  different eigenvalues. mixed solves the eigenproblem in single
+	 *  precision and refines the eigenpairs in double precision which
+	 *  is faster for a large number of variables. em fits a probabilistic
+	 *  pca by expectation maximization with as many components as retained
+	 *  eigenvectors (see set_num_retained). Each iteration costs
+	 *  O(records * variables * components) and the covariance matrix is
+	 *  never formed. Only the retained eigenpairs are computed. tsqr (tall
+	 *  and skinny QR) factorizes blocks of records in parallel, reduces their
+	 *  R factors pairwise in a tree and takes the singular value decomposition
+	 *  of the final R. It avoids the covariance matrix whose condition number
+	 *  is the square of the data's and suits many records of few variables.
+	 *  svd computes the thin singular value decomposition U S V^T of the
+	 *  records by divide and conquer. The principal components are U S so
+	 *  the records are not projected again. packed stores only the upper
+	 *  triangle of the covariance matrix and solves it with the LAPACK
+	 *  solver dspevd which halves the memory of the covariance matrix and
+	 *  avoids the workspace of a full copy. auto lets solve choose the
+	 *  solver from the number of records, variables and threads among the
+	 *  solvers that return all eigenpairs in double precision like dc
+	 *  (see utils::choose_solver and get_chosen_solver).
+	 *  Default is dc
+	 * @throws std::invalid_argument if solver is not equal to 'standard', 'dc', 'mixed', 'em', 'tsqr', 'svd', 'packed' or 'auto'
 	 */
 	void set_solver(const std::string& solver);
 	/**
@@ -117,15 +360,151 @@ public:
 	 * @return The solver
 	 */
 	std::string get_solver() const;
+	/**
+	 * @brief Returns the solver used by the last solve which differs from
+	 *  get_solver if the solver is auto
+	 * @return The solver or an empty string if solve has not been called
+	 */
+	std::string get_chosen_solver() const;
+	/**
+	 * @brief Sets the stopping criteria of the em solver which stops once
+	 *  the relative change of the loadings falls below the tolerance. The
+	 *  imputation of missing values uses the same criteria for the relative
+	 *  change of the imputed values
+	 * @param max_iterations The maximum number of iterations. Default is 500
+	 * @param tolerance The tolerance. Default is 1e-8
+	 * @param seed The random seed of the initial loadings
+	 * @throws std::invalid_argument if max_iterations is smaller than one or
+	 *  tolerance is negative
+	 */
+	void set_em_iterations(long max_iterations, double tolerance=1e-8, long seed=1);
+	/**
+	 * @brief Returns the maximum number of iterations of the em solver
+	 * @return The maximum number of iterations
+	 */
+	long get_em_iterations() const;
+	/**
+	 * @brief Sets the function called to report the progress of solve. The
+	 *  calls are serialized but may come from threads of the thread pool
+	 * @param callback The callback. An empty function disables reporting
+	 */
+	void set_progress_callback(const progress_callback& callback);
+	/**
+	 * @brief Sets the token checked by solve between stages and bootstrap
+	 *  replicates. A cancelled solve throws solve_cancelled and leaves the
+	 *  previous model published. All other results are undefined until
+	 *  the next successful solve
+	 * @param token The cancellation token
+	 */
+	void set_cancellation_token(const cancellation_token& token);
+	/**
+	 * @brief Sets a wall-clock budget for solve. Once exceeded no further
+	 *  bootstrap replicates are started and the bootstraps are reduced to
+	 *  the replicates completed so far (see get_energy_boot)
+	 * @param seconds The budget in seconds. Zero disables the budget
+	 * @throws std::invalid_argument if seconds is negative
+	 */
+	void set_time_budget(double seconds);
+	/**
+	 * @brief Returns the wall-clock budget for solve
+	 * @return The budget in seconds
+	 */
+	double get_time_budget() const;
+	/**
+	 * @brief Sets the number of threads used by this instance. Creates
+	 *  a thread pool owned by this instance (and its copies)
+	 * @param num_threads The number of threads
+	 * @throws std::invalid_argument if num_threads is smaller than one
+	 */
+	void set_num_threads(long num_threads);
+	/**
+	 * @brief Returns the number of threads used by this instance
+	 * @return The number of threads
+	 */
+	long get_num_threads() const;
+	/**
+	 * @brief Sets the thread pool used by this instance which allows
+	 *  several instances to share a pool or to use pools pinned to
+	 *  different CPUs. An empty pointer selects the pool of the calling
+	 *  thread which is the default thread pool unless solve runs as a task
+	 *  of another pool (see solve_all)
+	 * @param pool The thread pool
+	 */
+	void set_thread_pool(const std::shared_ptr<thread_pool>& pool);
+	/**
+	 * @brief Returns the thread pool used by this instance
+	 * @return The thread pool
+	 */
+	std::shared_ptr<thread_pool> get_thread_pool() const;
+	/**
+	 * @brief Sets how the pages of the data matrix are placed in memory.
+	 *  The data matrix is moved to newly placed storage immediately and
+	 *  whenever it grows. With 'first_touch' the storage is filled in
+	 *  parallel by all workers of the thread pool instead of by a single
+	 *  thread, so the pages are spread over the NUMA nodes of the workers.
+	 *  Blocks are handed out dynamically, so which node holds a given block
+	 *  is not determined and need not match the thread that later processes
+	 *  it. With 'interleave' the pages are spread round-robin over all NUMA
+	 *  nodes. 'default' leaves the placement to the allocator
+	 * @param placement Available options: 'default', 'first_touch' and 'interleave'
+	 * @param use_huge_pages Whether transparent huge pages are requested
+	 *  for the data matrix to reduce TLB misses on large data
+	 * @throws std::invalid_argument if the placement is not available
+	 */
+	void set_memory_placement(const std::string& placement, bool use_huge_pages=false);
+	/**
+	 * @brief Returns how the pages of the data matrix are placed in memory
+	 * @return The placement
+	 */
+	std::string get_memory_placement() const;
+	/**
+	 * @brief Returns whether transparent huge pages are requested for the data matrix
+	 * @return The boolean flag
+	 */
+	bool get_use_huge_pages() const;
+	/**
+	 * @brief Sets the memory resource the data matrix and the principal
+	 *  components are allocated from. Both are moved to the resource
+	 *  immediately and stay there when they are reallocated. Copies of this
+	 *  instance share the resource but start out on the global heap. The
+	 *  resource must outlive the blocks allocated from it
+	 * @param resource The memory resource. An empty pointer lets Armadillo
+	 *  allocate the matrices
+	 */
+	void set_memory_resource(const std::shared_ptr<memory_resource>& resource);
+	/**
+	 * @brief Returns the memory resource the data matrix and the principal
+	 *  components are allocated from
+	 * @return The memory resource or an empty pointer
+	 */
+	std::shared_ptr<memory_resource> get_memory_resource() const;
 	/**
 	 * @brief Solves the eigenproblem. Call this function after assigning
 	 *  the data records. This function also performs mean centering, optional
-	 *  normalization and optional bootstrapping
+	 *  normalization and optional bootstrapping on a copy of the records,
+	 *  so solving again after adding records includes all of them as added.
+	 *  Means and sigmas are computed from the observed values only. Missing
+	 *  values start at the mean and are then imputed from the retained
+	 *  eigenvectors, re-solving after each pass until the imputed values
+	 *  settle (an em algorithm). If all eigenvectors are retained the
+	 *  missing values stay at the mean
 	 * @throws std::invalid_argument if the number of variables is smaller than two
 	 * @throws std::logic_error if the number of previously assigned records is smaller than two
 	 * @throws std::runtime_error if the variables are to be normalized and one of the variables has zero variance
+	 * @throws std::runtime_error if one of the variables has fewer than two observed values
 	 */
 	void solve();
+	/**
+	 * @brief Solves the eigenproblem asynchronously on the thread pool of
+	 *  this instance. Until the returned future is ready only get_model,
+	 *  the projection functions and (with concurrent ingestion enabled)
+	 *  add_record may be called. Records added meanwhile are included by
+	 *  the next solve. Projections keep using the previous model until the
+	 *  new one is published
+	 * @return A future that becomes ready when solve is done. It holds the
+	 *  exception thrown by solve, if any
+	 */
+	std::future<void> solve_async();
 	/**
 	 * @brief Checks whether the eigenvectors are orthogonal. The closer
 	 *  the return value to one the more orthogonal are the eigenvectors
@@ -150,8 +529,10 @@ public:
 	void load(const std::string& basename);
 	/**
 	 * @brief Sets the number of retained eigenvectors. This affects the
-	 *  projection from and to the space of principal components
+	 *  projection from and to the space of principal components and is
+	 *  the number of eigenpairs computed by the em solver
 	 * @param num_retained The number of retained eigenvectors
+	 * @throws std::range_error if num_retained is out of range
 	 */
 	void set_num_retained(long num_retained);
 	/**
@@ -159,6 +540,14 @@ public:
 	 * @return The number of retained eigenvectors
 	 */
 	long get_num_retained() const;
+	/**
+	 * @brief Returns the current model used by the projections. Models are
+	 *  immutable and replaced as a whole by solve, load and set_num_retained,
+	 *  so the projection functions may be called from many threads while
+	 *  another thread re-solves. Each call sees one consistent model
+	 * @return The model
+	 */
+	std::shared_ptr<const pca_model<T>> get_model() const;
 	/**
 	 * @brief Projects a record in the variable space to a vector in the
 	 *  space of principal components
@@ -167,7 +556,17 @@ public:
 	 * @return A vector with a size that equals the number
 	 *  of variables assigned to pca
 	 */
-	std::vector<double> to_principal_space(const std::vector<double>& record) const;
+	std::vector<T> to_principal_space(const std::vector<T>& record) const;
+	/**
+	 * @brief Projects several records in the variable space to vectors in the
+	 *  space of principal components using the thread pool of this instance
+	 * @param records Vectors with a size that equals the number
+	 *  of variables assigned to pca
+	 * @return Vectors with a size that equals the number
+	 *  of variables assigned to pca
+	 * @throws std::domain_error if one of the records' sizes is not equal to the number of variables
+	 */
+	std::vector<std::vector<T>> to_principal_space(const std::vector<std::vector<T>>& records) const;
 	/**
 	 * @brief Projects a vector in the space of principal components
 	 *  to a record in the variable space
@@ -176,21 +575,34 @@ public:
 	 * @return A vector with a size that equals the number
 	 *  of variables assigned to pca
 	 */
-	std::vector<double> to_variable_space(const std::vector<double>& data) const;
+	std::vector<T> to_variable_space(const std::vector<T>& data) const;
 	/**
 	 * @brief Returns the energy of the principal component analysis.
 	 *  The energy is defined as the sum of the eigenvalues which equals
 	 *  the trace of the covariance matrix
 	 * @return The energy of the principal component analysis
 	 */
-	double get_energy() const;
+	T get_energy() const;
 	/**
 	 * @brief Returns the vector of the energy bootstraps which is only
 	 *  filled if the bootstrap flag is set to true. The vector's size
 	 *  equals the number of bootstraps
 	 * @return The vector of the energy bootstraps
 	 */
-	std::vector<double> get_energy_boot() const;
+	std::vector<T> get_energy_boot() const;
+	/**
+	 * @brief Returns a view of the energy bootstraps without copying them.
+	 *  The view is invalidated by solve, load and set_do_bootstrap
+	 * @return The view of the energy bootstraps
+	 */
+	vector_view<T> view_energy_boot() const;
+	/**
+	 * @brief Returns the noise variance of the probabilistic pca model, i.e.
+	 *  the average variance of the dimensions not spanned by the retained
+	 *  eigenvectors. It is zero if all eigenvectors are retained
+	 * @return The noise variance
+	 */
+	T get_noise_variance() const;
 	/**
 	 * @brief Returns the eigen_index'th eigenvalue starting at zero. Note that
 	 *  the eigenvalues are normalized by their sum which equals the energy
@@ -200,13 +612,20 @@ public:
 	 * @return An eigenvalue
 	 * @throws std:range_error if eigen_index is out of range
 	 */
-	double get_eigenvalue(long eigen_index) const;
+	T get_eigenvalue(long eigen_index) const;
 	/**
 	 * @brief Returns the eigenvalues. Note that the eigenvalues are normalized
-	 * 	by their sum which equals the energy of the eigenproblem
+	 * 	by their sum which equals the energy of the eigenproblem. The em
+	 * 	solver returns the retained eigenvalues only
 	 * @return The eigenvalues
 	 */
-	std::vector<double> get_eigenvalues() const;
+	std::vector<T> get_eigenvalues() const;
+	/**
+	 * @brief Returns a view of the eigenvalues without copying them.
+	 *  The view is invalidated by solve and load
+	 * @return The view of the eigenvalues
+	 */
+	vector_view<T> view_eigenvalues() const;
 	/**
 	 * @brief Returns the vector of the eigenvalue bootstraps which is only
 	 *  filled if the bootstrap flag is set to true. The vector's size
@@ -216,7 +635,16 @@ public:
 	 * @return The vector of the eigenvalue bootstraps
 	 * @throws std:range_error if eigen_index is out of range
 	 */
-	std::vector<double> get_eigenvalue_boot(long eigen_index) const;
+	std::vector<T> get_eigenvalue_boot(long eigen_index) const;
+	/**
+	 * @brief Returns a view of the eigenvalue bootstraps without copying them.
+	 *  The view is invalidated by solve, load and set_do_bootstrap
+	 * @param eigen_index The index corresponding to the eigen_index'th
+	 *  eigenvalue starting at zero
+	 * @return The view of the eigenvalue bootstraps
+	 * @throws std:range_error if eigen_index is out of range
+	 */
+	vector_view<T> view_eigenvalue_boot(long eigen_index) const;
 	/**
 	 * @brief Returns the eigen_index'th eigenvector starting at zero.
 	 *  The vector's size equals the number of variables
@@ -225,7 +653,16 @@ public:
 	 * @return The eigenvector
 	 * @throws std:range_error if eigen_index is out of range
 	 */
-	std::vector<double> get_eigenvector(long eigen_index) const;
+	std::vector<T> get_eigenvector(long eigen_index) const;
+	/**
+	 * @brief Returns a view of the eigen_index'th eigenvector without
+	 *  copying it. The view is invalidated by solve and load
+	 * @param eigen_index The index corresponding to the eigen_index'th
+	 *  eigenvalue starting at zero
+	 * @return The view of the eigenvector
+	 * @throws std:range_error if eigen_index is out of range
+	 */
+	vector_view<T> view_eigenvector(long eigen_index) const;
 	/**
 	 * @brief Returns the eigen_index'th principal component starting at zero.
 	 *  The vector's size equals the number of records
@@ -234,20 +671,42 @@ public:
 	 * @return The principal component
 	 * @throws std:range_error if eigen_index is out of range
 	 */
-	std::vector<double> get_principal(long eigen_index) const;
+	std::vector<T> get_principal(long eigen_index) const;
+	/**
+	 * @brief Returns a view of the eigen_index'th principal component
+	 *  without copying it. The view is invalidated by solve, load and
+	 *  set_memory_resource
+	 * @param eigen_index The index corresponding to the eigen_index'th
+	 *  eigenvalue starting at zero
+	 * @return The view of the principal component
+	 * @throws std:range_error if eigen_index is out of range
+	 */
+	vector_view<T> view_principal(long eigen_index) const;
 	/**
 	 * @brief Returns the mean values (average) of the records assigned to pca.
 	 *  The vector's size equals the number of variables
 	 * @return The mean values
 	 * @throws std:range_error if eigen_index is out of range
 	 */
-	std::vector<double> get_mean_values() const;
+	std::vector<T> get_mean_values() const;
+	/**
+	 * @brief Returns a view of the mean values without copying them.
+	 *  The view is invalidated by solve and load
+	 * @return The view of the mean values
+	 */
+	vector_view<T> view_mean_values() const;
 	/**
 	 * @brief Returns the sigma values (standard deviation) of the records assigned to pca.
 	 *  The vector's size equals the number of variables
 	 * @return The sigma values
 	 */
-	std::vector<double> get_sigma_values() const;
+	std::vector<T> get_sigma_values() const;
+	/**
+	 * @brief Returns a view of the sigma values without copying them.
+	 *  The view is invalidated by solve and load
+	 * @return The view of the sigma values
+	 */
+	vector_view<T> view_sigma_values() const;
 
 protected:
 
@@ -255,36 +714,198 @@ protected:
 	long num_records_;
 	long record_buffer_;
 	std::string solver_;
+	std::string chosen_solver_;
 	bool do_normalize_;
 	bool do_bootstrap_;
+	bool do_concurrent_ingestion_;
+	std::string memory_placement_;
+	bool use_huge_pages_;
 	long num_bootstraps_;
 	long bootstrap_seed_;
 	long num_retained_;
-	arma::Mat<double> data_;
-	arma::Col<double> energy_;
-	arma::Col<double> energy_boot_;
-	arma::Col<double> eigval_;
-	arma::Mat<double> eigval_boot_;
-	arma::Mat<double> eigvec_;
-	arma::Mat<double> proj_eigvec_;
-	arma::Mat<double> princomp_;
-	arma::Col<double> mean_;
-	arma::Col<double> sigma_;
+	long em_max_iterations_;
+	double em_tolerance_;
+	long em_seed_;
+	long num_missing_;
+	std::vector<std::uint64_t> missing_mask_;
+	std::vector<double> weights_;
+	arma::Mat<T> data_;
+	arma::Col<T> energy_;
+	arma::Col<T> energy_boot_;
+	arma::Col<T> eigval_;
+	arma::Mat<T> eigval_boot_;
+	arma::Mat<T> eigvec_;
+	arma::Mat<T> proj_eigvec_;
+	arma::Mat<T> princomp_;
+	arma::Col<T> mean_;
+	arma::Col<T> sigma_;
+	std::shared_ptr<memory_resource> memory_resource_;
+	memory_block data_block_;
+	memory_block princomp_block_;
+	std::shared_ptr<thread_pool> thread_pool_;
+	sharded_record_buffer<T> pending_records_;
+	std::shared_ptr<const pca_model<T>> model_;
+	progress_callback progress_callback_;
+	cancellation_token cancellation_token_;
+	double time_budget_;
 	void initialize_();
 	void assert_num_vars_();
-	void resize_data_if_needed_();
-	void bootstrap_eigenvalues_();
+	void resize_data_if_needed_(long num_new=1);
+	void resize_data_(long num_rows);
+	void move_to_resource_(arma::Mat<T>& matrix, memory_block& block);
+	arma::Mat<T> make_resource_matrix_(long num_rows, long num_cols, memory_block& block) const;
+	arma::Mat<T> copy_records_(memory_block& block) const;
+	void mark_missing_(long record_index, const T* record);
+	void store_weight_(long record_index, double weight);
+	void scale_records_(arma::Mat<T>& data, bool inverse) const;
+	double get_covariance_scale_() const;
+	std::vector<arma::uword> get_missing_indices_() const;
+	double solve_data_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec, arma::Mat<double>& scores) const;
+	void bootstrap_eigenvalues_(const arma::Mat<T>& data, const std::chrono::steady_clock::time_point& deadline);
+	void report_progress_(const std::string& stage, double fraction, long replicate) const;
+	void check_cancelled_() const;
+	void publish_model_();
+	void solve_eigenproblem_(arma::Col<double>& eigval, arma::Mat<double>& eigvec, const arma::Mat<double>& cov_mat) const;
+	double solve_em_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec) const;
+	void solve_tsqr_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec) const;
+	void solve_svd_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec, arma::Mat<double>& scores) const;
 };
+/**
+ * @brief Principal component analysis in double precision
+ */
+typedef basic_pca<double> pca;
+/**
+ * @brief Principal component analysis in single precision
+ */
+typedef basic_pca<float> fpca;
+/**
+ * @brief Solves several pca instances on a thread pool, one task per
+ * 	instance, starting with the largest. Nested parallel work such as
+ * 	bootstrapping is spread over idle threads by work stealing. Instances
+ * 	with a thread pool of their own keep using it
+ * @param models The pca instances
+ * @param pool The thread pool. An empty pointer selects the pool of the calling thread
+ * @throws The first exception thrown by one of the solves. The remaining
+ * 	instances may then be left unsolved
+ */
+template<typename T>
+void solve_all(const std::vector<basic_pca<T>*>& models, const std::shared_ptr<thread_pool>& pool=std::shared_ptr<thread_pool>());
 /**
  * @brief Utilities
  */
 namespace utils {
 /**
- * @brief Computes the covariance matrix of its input matrix
+ * @brief Computes the covariance matrix of its input matrix. The covariance
+ * 	is accumulated in double precision regardless of the element type
  * @param data The input matrix
  * @return The covariance matrix
  */
-arma::Mat<double> make_covariance_matrix(const arma::Mat<double>& data);
+template<typename T>
+arma::Mat<double> make_covariance_matrix(const arma::Mat<T>& data);
+/**
+ * @brief Computes the upper triangle of the covariance matrix of its input
+ * 	matrix in packed storage, i.e. element (i, j) with i <= j is stored at
+ * 	i + j (j + 1) / 2. Pairs of column blocks are accumulated in parallel
+ * 	in double precision without forming the full matrix
+ * @param data The input matrix
+ * @return The packed covariance matrix
+ */
+template<typename T>
+arma::Col<double> make_packed_covariance_matrix(const arma::Mat<T>& data);
+/**
+ * @brief Solves the eigenproblem of a symmetric matrix given by its packed
+ * 	upper triangle (see make_packed_covariance_matrix) using the LAPACK
+ * 	divide and conquer solver dspevd
+ * @param eigval The eigenvalues in ascending order
+ * @param eigvec The eigenvectors (column-wise)
+ * @param packed The packed matrix which is overwritten
+ * @param num_vars The number of rows and columns of the matrix
+ * @throws std::range_error if packed has not num_vars (num_vars + 1) / 2 elements
+ * @throws std::runtime_error if the solver fails
+ */
+void eig_sym_packed(arma::Col<double>& eigval, arma::Mat<double>& eigvec, arma::Col<double>& packed, long num_vars);
+/**
+ * @brief Returns the instruction set used by the vectorized kernels computing
+ * 	the column statistics and projections. The instruction set is detected at
+ * 	runtime and is one of avx512, avx2 or generic
+ * @return The instruction set
+ */
+std::string get_instruction_set();
+/**
+ * @brief Sets the instruction set used by the vectorized kernels computing
+ * 	the column statistics and projections
+ * @param instruction_set Available options: 'avx512', 'avx2' and 'generic'
+ * @throws std::invalid_argument if the instruction set is not available or
+ * 	not supported by the CPU
+ */
+void set_instruction_set(const std::string& instruction_set);
+/**
+ * @brief Refines approximate eigenpairs of a symmetric matrix in place using
+ * 	the iterative refinement of Ogita and Aishima. Each iteration consists of
+ * 	matrix products only and roughly doubles the number of correct digits for
+ * 	well separated eigenvalues. Clustered eigenvalues are only re-orthogonalized
+ * @param eigval The eigenvalues to be refined
+ * @param eigvec The eigenvectors to be refined (column-wise)
+ * @param mat The symmetric matrix
+ * @param num_iter The number of refinement iterations
+ * @throws std::range_error if the dimensions of the arguments do not match
+ */
+void refine_symmetric_eigenpairs(arma::Col<double>& eigval, arma::Mat<double>& eigvec,
+								 const arma::Mat<double>& mat, long num_iter=2);
+/**
+ * @brief Estimates the time a solver of basic_pca takes for data of the
+ * 	given shape. The cost model counts the operations of each stage
+ * 	(covariance, eigensolve, factorizations and the final projection) and
+ * 	converts them to seconds with rates that are measured once by small
+ * 	benchmarks at first use
+ * @param solver One of 'standard', 'dc', 'mixed', 'em', 'tsqr', 'svd' and 'packed'
+ * @param num_records The number of records
+ * @param num_vars The number of variables
+ * @param num_components The number of components computed by the em solver
+ * @param num_threads The number of threads
+ * @return The estimated time in seconds
+ * @throws std::invalid_argument if the solver is not available or the shape is invalid
+ */
+double estimate_solve_seconds(const std::string& solver, long num_records, long num_vars, long num_components, long num_threads);
+/**
+ * @brief Chooses the solver with the smallest estimated time (see
+ * 	estimate_solve_seconds) among dc, packed, tsqr and svd, which return
+ * 	the same eigenpairs. em and mixed are never chosen because they change
+ * 	the number or the accuracy of the results. tsqr and svd are only
+ * 	considered if there are at least as many records as variables.
+ * 	Solvers are skipped if their workspace exceeds half of the available
+ * 	memory. The packed solver is only chosen if a full covariance matrix
+ * 	does not fit
+ * @param num_records The number of records
+ * @param num_vars The number of variables
+ * @param num_threads The number of threads
+ * @return The solver
+ * @throws std::invalid_argument if the shape is invalid
+ */
+std::string choose_solver(long num_records, long num_vars, long num_threads);
+/**
+ * @brief Returns the number of NUMA nodes that are online
+ * @return The number of NUMA nodes (one if unknown)
+ */
+long get_num_numa_nodes();
+/**
+ * @brief Resizes a matrix like arma::Mat::resize but moves it to newly
+ * 	allocated storage whose pages are placed as requested. The elements are
+ * 	copied (or zeroed) in parallel on the current thread pool which is the
+ * 	first touch of each page. Blocks are assigned to workers dynamically.
+ * 	Placement is a best effort and silently falls back if the system does
+ * 	not support it
+ * @param data The matrix to be resized
+ * @param n_rows The new number of rows
+ * @param n_cols The new number of columns
+ * @param placement One of 'default', 'first_touch' and 'interleave'
+ * @param use_huge_pages Whether transparent huge pages are requested
+ * @param memory Storage for n_rows times n_cols elements which the matrix
+ * 	uses without owning it. A null pointer lets Armadillo allocate the storage
+ * @throws std::invalid_argument if the placement is not available
+ */
+template<typename T>
+void resize_placed(arma::Mat<T>& data, long n_rows, long n_cols, const std::string& placement, bool use_huge_pages, T* memory=nullptr);
 /**
  * @brief Computes a shuffled matrix from the input matrix. The resulting matrix
  * 	has the same dimensions as the input matrix. Shuffeling is done along
@@ -292,13 +913,24 @@ arma::Mat<double> make_covariance_matrix(const arma::Mat<double>& data);
  * @param data The input matrix
  * @return The shuffled matrix
  */
-arma::Mat<double> make_shuffled_matrix(const arma::Mat<double>& data);
+template<typename T>
+arma::Mat<T> make_shuffled_matrix(const arma::Mat<T>& data);
+/**
+ * @brief Computes a shuffled matrix from the input matrix drawing the
+ * 	row indices from the given random generator
+ * @param data The input matrix
+ * @param generator The random generator
+ * @return The shuffled matrix
+ */
+template<typename T>
+arma::Mat<T> make_shuffled_matrix(const arma::Mat<T>& data, std::mt19937& generator);
 /**
  * @brief Computes the column means of the input matrix
  * @param data The input matrix
  * @return The column means
  */
-arma::Col<double> compute_column_means(const arma::Mat<double>& data);
+template<typename T>
+arma::Col<T> compute_column_means(const arma::Mat<T>& data);
 /**
  * @brief Removes the column means from the input matrix
  * @param data The input matrix to be altered
@@ -306,13 +938,15 @@ arma::Col<double> compute_column_means(const arma::Mat<double>& data);
  * @throws std::range_error if number of columns of data is not equal to
  * 	number of elements of means
  */
-void remove_column_means(arma::Mat<double>& data, const arma::Col<double>& means);
+template<typename T>
+void remove_column_means(arma::Mat<T>& data, const arma::Col<T>& means);
 /**
  * @brief Computes the column root mean squared (rms) of the input matrix
  * @param data The input matrix
  * @return The column root mean squared
  */
-arma::Col<double> compute_column_rms(const arma::Mat<double>& data);
+template<typename T>
+arma::Col<T> compute_column_rms(const arma::Mat<T>& data);
 /**
  * @brief Normalizes data by dividing each column with the corresponding
  * 	entry in sigmas
@@ -322,13 +956,15 @@ arma::Col<double> compute_column_rms(const arma::Mat<double>& data);
  * @throws std::range_error if number of columns of data is not equal to
  * 	number of elements of rms
  */
-void normalize_by_column(arma::Mat<double>& data, const arma::Col<double>& rms);
+template<typename T>
+void normalize_by_column(arma::Mat<T>& data, const arma::Col<T>& rms);
 /**
  * @brief Enforces a positive sign on the maximum value of each column and
  * 	then also scales the remaining values of each column
  * @param data The input matrix to be altered
  */
-void enforce_positive_sign_by_column(arma::Mat<double>& data);
+template<typename T>
+void enforce_positive_sign_by_column(arma::Mat<T>& data);
 /**
  * @brief Extracts a column vector from the input matrix
  * @param data The input matrix
@@ -336,7 +972,8 @@ void enforce_positive_sign_by_column(arma::Mat<double>& data);
  * @return The extracted column vector
  * @throws std:range_error if index is out of range
  */
-std::vector<double> extract_column_vector(const arma::Mat<double>& data, long index);
+template<typename T>
+std::vector<T> extract_column_vector(const arma::Mat<T>& data, long index);
 /**
  * @brief Extracts a row vector from the input matrix
  * @param data The input matrix
@@ -344,7 +981,27 @@ std::vector<double> extract_column_vector(const arma::Mat<double>& data, long in
  * @return The extracted row vector
  * @throws std:range_error if index is out of range
  */
-std::vector<double> extract_row_vector(const arma::Mat<double>& data, long index);
+template<typename T>
+std::vector<T> extract_row_vector(const arma::Mat<T>& data, long index);
+/**
+ * @brief Returns a view of a column of the input matrix without copying it
+ * @param data The input matrix
+ * @param index The column index
+ * @return The view of the column
+ * @throws std:range_error if index is out of range
+ */
+template<typename T>
+vector_view<T> view_column(const arma::Mat<T>& data, long index);
+/**
+ * @brief Returns a view of a row of the input matrix without copying it.
+ * 	The stride equals the number of rows of the matrix
+ * @param data The input matrix
+ * @param index The row index
+ * @return The view of the row
+ * @throws std:range_error if index is out of range
+ */
+template<typename T>
+vector_view<T> view_row(const arma::Mat<T>& data, long index);
 /**
  * @brief Asserts the boolean result of a file check
  * @param is_file_good The boolean result of a file check
@@ -0,0 +1,208 @@
+#pragma once
+/**
+ * @file pca_batch.h
+ * @brief Principal component analysis of many small independent models
+ */
+#include "pca.h"
+
+namespace stats {
+/**
+ * @brief A class template solving many small independent principal component
+ * 	analyses at once. Records are not stored. Instead each model keeps a
+ * 	running mean and co-moment matrix in one contiguous arena shared by all
+ * 	models, and solve computes all models in parallel on the thread pool
+ * @tparam T The element type of records and results. Supported are float
+ * 	and double. Moments are always accumulated in double precision
+ */
+template<typename T>
+class basic_pca_batch {
+public:
+	/**
+	 * @brief The element type
+	 */
+	typedef T value_type;
+	/**
+	 * @brief Constructor
+	 */
+	basic_pca_batch();
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~basic_pca_batch();
+	/**
+	 * @brief Adds a model. Must not be called concurrently with any
+	 * 	other member function
+	 * @param num_vars Number of variables of the model
+	 * @return The index of the model
+	 * @throws std::invalid_argument if num_vars is smaller than two
+	 */
+	long add_model(long num_vars);
+	/**
+	 * @brief Returns the number of models
+	 * @return The number of models
+	 */
+	long get_num_models() const;
+	/**
+	 * @brief Returns the number of variables of a model
+	 * @param model The model index
+	 * @return The number of variables
+	 * @throws std::range_error if model is out of range
+	 */
+	long get_num_variables(long model) const;
+	/**
+	 * @brief Adds a data record to a model. Records may be added to
+	 * 	different models from different threads at once
+	 * @param model The model index
+	 * @param record A vector with a size that equals the number
+	 *  of variables of the model
+	 * @throws std::range_error if model is out of range
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 */
+	void add_record(long model, const std::vector<T>& record);
+	/**
+	 * @brief Returns the number of records added to a model
+	 * @param model The model index
+	 * @return The number of records
+	 * @throws std::range_error if model is out of range
+	 */
+	long get_num_records(long model) const;
+	/**
+	 * @brief Sets whether to normalize each variable using the
+	 *  temporal standard deviation prior to solving the eigenproblems
+	 * @param do_normalize The boolean flag
+	 */
+	void set_do_normalize(bool do_normalize);
+	/**
+	 * @brief Returns whether the variables are normalized
+	 * @return The boolean flag
+	 */
+	bool get_do_normalize() const;
+	/**
+	 * @brief Sets the algorithmic solver to be used to solve the eigenproblems
+	 * @param solver Available options: 'standard', 'dc' and 'packed' where
+	 *  packed solves the packed co-moments with the LAPACK solver dspevd
+	 *  without forming the full covariance matrix. Default is dc
+	 * @throws std::invalid_argument if solver is not equal to 'standard', 'dc' or 'packed'
+	 */
+	void set_solver(const std::string& solver);
+	/**
+	 * @brief Returns the solver to be used
+	 * @return The solver
+	 */
+	std::string get_solver() const;
+	/**
+	 * @brief Sets the number of threads used by this instance. Creates
+	 *  a thread pool owned by this instance (and its copies)
+	 * @param num_threads The number of threads
+	 * @throws std::invalid_argument if num_threads is smaller than one
+	 */
+	void set_num_threads(long num_threads);
+	/**
+	 * @brief Returns the number of threads used by this instance
+	 * @return The number of threads
+	 */
+	long get_num_threads() const;
+	/**
+	 * @brief Sets the thread pool used by this instance. An empty pointer
+	 *  selects the pool of the calling thread
+	 * @param pool The thread pool
+	 */
+	void set_thread_pool(const std::shared_ptr<thread_pool>& pool);
+	/**
+	 * @brief Returns the thread pool used by this instance
+	 * @return The thread pool
+	 */
+	std::shared_ptr<thread_pool> get_thread_pool() const;
+	/**
+	 * @brief Solves the eigenproblems of all models
+	 * @throws std::logic_error if a model has less than two records
+	 * @throws std::runtime_error if the variables are to be normalized and
+	 * 	one of the variables of a model has zero variance
+	 */
+	void solve();
+	/**
+	 * @brief Returns the energy of a model
+	 * @param model The model index
+	 * @return The energy
+	 * @throws std::range_error if model is out of range
+	 */
+	T get_energy(long model) const;
+	/**
+	 * @brief Returns the eigenvalues of a model normalized by their sum
+	 * @param model The model index
+	 * @return The eigenvalues
+	 * @throws std::range_error if model is out of range
+	 */
+	std::vector<T> get_eigenvalues(long model) const;
+	/**
+	 * @brief Returns the eigen_index'th eigenvector of a model
+	 * @param model The model index
+	 * @param eigen_index The index corresponding to the eigen_index'th
+	 *  eigenvalue starting at zero
+	 * @return The eigenvector
+	 * @throws std::range_error if model or eigen_index is out of range
+	 */
+	std::vector<T> get_eigenvector(long model, long eigen_index) const;
+	/**
+	 * @brief Returns the mean values of the records of a model
+	 * @param model The model index
+	 * @return The mean values
+	 * @throws std::range_error if model is out of range
+	 */
+	std::vector<T> get_mean_values(long model) const;
+	/**
+	 * @brief Returns the sigma values of the records of a model
+	 * @param model The model index
+	 * @return The sigma values
+	 * @throws std::range_error if model is out of range
+	 */
+	std::vector<T> get_sigma_values(long model) const;
+	/**
+	 * @brief Projects a record to the space of principal components of a model
+	 * @param model The model index
+	 * @param record A vector with a size that equals the number
+	 *  of variables of the model
+	 * @return A vector with a size that equals the number of variables
+	 * @throws std::range_error if model is out of range
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 */
+	std::vector<T> to_principal_space(long model, const std::vector<T>& record) const;
+	/**
+	 * @brief Projects a vector in the space of principal components of a
+	 * 	model to a record in the variable space
+	 * @param model The model index
+	 * @param data A vector with a size that equals the number
+	 *  of variables of the model
+	 * @return A vector with a size that equals the number of variables
+	 * @throws std::range_error if model is out of range
+	 * @throws std::domain_error if data's size is not equal to the number of variables
+	 */
+	std::vector<T> to_variable_space(long model, const std::vector<T>& data) const;
+
+protected:
+
+	std::string solver_;
+	bool do_normalize_;
+	std::vector<long> num_vars_;
+	std::vector<long> num_records_;
+	std::vector<long> moment_offsets_;
+	std::vector<long> result_offsets_;
+	std::vector<double> moments_;
+	std::vector<T> results_;
+	std::vector<T> energy_;
+	std::shared_ptr<thread_pool> thread_pool_;
+	void assert_model_(long model) const;
+	void assert_size_(long model, long size) const;
+	void solve_model_(long model, std::vector<double>& workspace);
+	const T* get_results_(long model) const;
+};
+/**
+ * @brief Batched principal component analysis in double precision
+ */
+typedef basic_pca_batch<double> pca_batch;
+/**
+ * @brief Batched principal component analysis in single precision
+ */
+typedef basic_pca_batch<float> fpca_batch;
+
+} //stats
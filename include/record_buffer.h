@@ -0,0 +1,93 @@
+#pragma once
+/**
+ * @file record_buffer.h
+ * @brief A record buffer for concurrent producers
+ */
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace stats {
+/**
+ * @brief A record buffer that many threads can append to concurrently.
+ * 	Each thread appends to one of several shards which are guarded by
+ * 	their own mutex, so producers on different threads rarely contend
+ * @tparam T The element type. Supported are float and double
+ */
+template<typename T>
+class sharded_record_buffer {
+public:
+	/**
+	 * @brief The records taken out of one shard with one weight per record
+	 */
+	struct chunk {
+		std::vector<T> values;
+		std::vector<double> weights;
+	};
+	/**
+	 * @brief Constructor
+	 * @param num_shards The number of shards. Zero selects twice the
+	 * 	number of hardware threads but at least eight shards
+	 */
+	explicit sharded_record_buffer(long num_shards=0);
+	/**
+	 * @brief Copy constructor. Copies the pending records
+	 * @param other Another buffer
+	 */
+	sharded_record_buffer(const sharded_record_buffer& other);
+	/**
+	 * @brief Assignment operator. Copies the pending records
+	 * @param other Another buffer
+	 * @return This buffer
+	 */
+	sharded_record_buffer& operator=(const sharded_record_buffer& other);
+	/**
+	 * @brief Returns the number of shards
+	 * @return The number of shards
+	 */
+	long get_num_shards() const;
+	/**
+	 * @brief Appends a record with a weight of one. This function is
+	 * 	thread-safe. Records appended by the same thread keep their order
+	 * @param record The record's values
+	 * @param num_vars The number of values
+	 */
+	void append(const T* record, long num_vars);
+	/**
+	 * @brief Appends a record with its weight. This function is
+	 * 	thread-safe. Records appended by the same thread keep their order
+	 * @param record The record's values
+	 * @param num_vars The number of values
+	 * @param weight The weight which is kept in double precision
+	 */
+	void append(const T* record, long num_vars, double weight);
+	/**
+	 * @brief Returns the number of pending values summed over all shards
+	 * @return The number of values
+	 */
+	long size() const;
+	/**
+	 * @brief Takes the pending records out of the buffer, one chunk per
+	 * 	non-empty shard in shard order. This function is thread-safe and
+	 * 	returns all records appended before the call
+	 * @return The records of the shards
+	 */
+	std::vector<chunk> take();
+	/**
+	 * @brief Discards all pending values
+	 */
+	void clear();
+
+private:
+	struct shard {
+		mutable std::mutex mutex;
+		std::vector<T> values;
+		std::vector<double> weights;
+		char padding[64];
+	};
+	long num_shards_;
+	std::unique_ptr<shard[]> shards_;
+	shard& get_shard_();
+};
+
+} //stats
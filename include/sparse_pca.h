@@ -0,0 +1,228 @@
+#pragma once
+/**
+ * @file sparse_pca.h
+ * @brief Principal component analysis of sparse records
+ */
+#include "pca.h"
+
+namespace stats {
+/**
+ * @brief A class template for the principal component analysis of sparse
+ * 	records given as index/value pairs. Records are kept in compressed
+ * 	sparse column form with one column per record and are never densified.
+ * 	The leading components are computed by randomized subspace iteration
+ * 	where centering (and normalization) are applied implicitly inside the
+ * 	products with the sparse data matrix, i.e. (X - 1 mean^T) M equals
+ * 	X M - 1 (mean^T M). Memory and time per iteration scale with the number
+ * 	of non-zeros instead of the number of records times variables
+ * @tparam T The element type of records and results. Supported are float
+ * 	and double. Products and moments are computed in double precision
+ */
+template<typename T>
+class basic_sparse_pca {
+public:
+	/**
+	 * @brief The element type
+	 */
+	typedef T value_type;
+	/**
+	 * @brief Constructor
+	 * @param num_vars Number of variables
+	 * @throws std::invalid_argument if num_vars is smaller than two
+	 */
+	explicit basic_sparse_pca(long num_vars);
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~basic_sparse_pca();
+	/**
+	 * @brief Returns the number of variables
+	 * @return The number of variables
+	 */
+	long get_num_variables() const;
+	/**
+	 * @brief Adds a sparse data record. Variables not listed are zero
+	 * @param indices The indices of the non-zero variables in any order
+	 * @param values The values of the non-zero variables
+	 * @throws std::domain_error if indices and values have different sizes
+	 * @throws std::range_error if one of the indices is out of range
+	 * @throws std::invalid_argument if an index is given more than once
+	 */
+	void add_record(const std::vector<long>& indices, const std::vector<T>& values);
+	/**
+	 * @brief Adds a dense data record of which only the non-zeros are stored
+	 * @param record A vector with a size that equals the number of variables
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 */
+	void add_record(const std::vector<T>& record);
+	/**
+	 * @brief Returns the number of records
+	 * @return The number of records
+	 */
+	long get_num_records() const;
+	/**
+	 * @brief Returns the number of stored non-zero values
+	 * @return The number of non-zeros
+	 */
+	long get_num_nonzeros() const;
+	/**
+	 * @brief Sets whether to normalize each variable using the
+	 *  temporal standard deviation prior to solving the eigenproblem
+	 * @param do_normalize The boolean flag
+	 */
+	void set_do_normalize(bool do_normalize);
+	/**
+	 * @brief Returns whether the variables are normalized
+	 * @return The boolean flag
+	 */
+	bool get_do_normalize() const;
+	/**
+	 * @brief Sets the number of leading components to be computed. At most
+	 * 	the number of variables or records are computed
+	 * @param num_components The number of components. Default is ten
+	 * @throws std::range_error if num_components is smaller than one
+	 */
+	void set_num_components(long num_components);
+	/**
+	 * @brief Returns the number of leading components to be computed
+	 * @return The number of components
+	 */
+	long get_num_components() const;
+	/**
+	 * @brief Sets the number of subspace iterations
+	 * @param num_iterations The number of iterations. Default is four
+	 * @param seed The random seed of the start subspace
+	 * @throws std::invalid_argument if num_iterations is negative
+	 */
+	void set_num_iterations(long num_iterations, long seed=1);
+	/**
+	 * @brief Returns the number of subspace iterations
+	 * @return The number of iterations
+	 */
+	long get_num_iterations() const;
+	/**
+	 * @brief Sets the number of additional subspace dimensions iterated
+	 * 	along with the components to speed up convergence
+	 * @param oversampling The oversampling. Default is ten
+	 * @throws std::invalid_argument if oversampling is negative
+	 */
+	void set_oversampling(long oversampling);
+	/**
+	 * @brief Returns the oversampling
+	 * @return The oversampling
+	 */
+	long get_oversampling() const;
+	/**
+	 * @brief Sets the number of threads used by this instance. Creates
+	 *  a thread pool owned by this instance (and its copies)
+	 * @param num_threads The number of threads
+	 * @throws std::invalid_argument if num_threads is smaller than one
+	 */
+	void set_num_threads(long num_threads);
+	/**
+	 * @brief Sets the thread pool used by this instance. An empty pointer
+	 *  selects the pool of the calling thread
+	 * @param pool The thread pool
+	 */
+	void set_thread_pool(const std::shared_ptr<thread_pool>& pool);
+	/**
+	 * @brief Returns the thread pool used by this instance
+	 * @return The thread pool
+	 */
+	std::shared_ptr<thread_pool> get_thread_pool() const;
+	/**
+	 * @brief Computes the leading components of the implicitly centered
+	 * 	sparse data matrix
+	 * @throws std::logic_error if the number of records is smaller than two
+	 * @throws std::runtime_error if the variables are to be normalized and
+	 * 	one of the variables has zero variance
+	 */
+	void solve();
+	/**
+	 * @brief Returns the energy which is the total variance of all
+	 * 	variables and not only of the computed components
+	 * @return The energy
+	 */
+	T get_energy() const;
+	/**
+	 * @brief Returns the eigen_index'th eigenvalue starting at zero
+	 * 	normalized by the energy
+	 * @param eigen_index The index of the eigenvalue
+	 * @return An eigenvalue
+	 * @throws std::range_error if eigen_index is out of range
+	 */
+	T get_eigenvalue(long eigen_index) const;
+	/**
+	 * @brief Returns the computed eigenvalues normalized by the energy
+	 * @return The eigenvalues
+	 */
+	std::vector<T> get_eigenvalues() const;
+	/**
+	 * @brief Returns the eigen_index'th eigenvector starting at zero
+	 * @param eigen_index The index of the eigenvector
+	 * @return The eigenvector
+	 * @throws std::range_error if eigen_index is out of range
+	 */
+	std::vector<T> get_eigenvector(long eigen_index) const;
+	/**
+	 * @brief Returns the mean values of all variables
+	 * @return The mean values
+	 */
+	std::vector<T> get_mean_values() const;
+	/**
+	 * @brief Returns the sigma values of all variables
+	 * @return The sigma values
+	 */
+	std::vector<T> get_sigma_values() const;
+	/**
+	 * @brief Projects a sparse record to the space of principal components
+	 * @param indices The indices of the non-zero variables
+	 * @param values The values of the non-zero variables
+	 * @return A vector with a size that equals the number of computed components
+	 * @throws std::logic_error if solve has not been called
+	 * @throws std::domain_error if indices and values have different sizes
+	 * @throws std::range_error if one of the indices is out of range
+	 */
+	std::vector<T> to_principal_space(const std::vector<long>& indices, const std::vector<T>& values) const;
+	/**
+	 * @brief Projects a dense record to the space of principal components
+	 * @param record A vector with a size that equals the number of variables
+	 * @return A vector with a size that equals the number of computed components
+	 * @throws std::logic_error if solve has not been called
+	 * @throws std::domain_error if record's size is not equal to the number of variables
+	 */
+	std::vector<T> to_principal_space(const std::vector<T>& record) const;
+
+protected:
+
+	long num_vars_;
+	long num_components_;
+	long num_iterations_;
+	long oversampling_;
+	long seed_;
+	bool do_normalize_;
+	double energy_;
+	std::vector<arma::uword> row_indices_;
+	std::vector<arma::uword> col_ptrs_;
+	std::vector<T> values_;
+	arma::Col<double> mean_;
+	arma::Col<double> sigma_;
+	arma::Col<double> eigval_;
+	arma::Mat<double> eigvec_;
+	arma::Row<double> projection_offset_;
+	std::shared_ptr<thread_pool> thread_pool_;
+	void assert_solved_() const;
+	void assert_indices_(const std::vector<long>& indices, const std::vector<T>& values) const;
+	arma::Mat<double> multiply_(const arma::SpMat<T>& records, const arma::Mat<double>& mat) const;
+	arma::Mat<double> multiply_transposed_(const arma::SpMat<T>& variables, const arma::Mat<double>& mat) const;
+};
+/**
+ * @brief Sparse principal component analysis in double precision
+ */
+typedef basic_sparse_pca<double> sparse_pca;
+/**
+ * @brief Sparse principal component analysis in single precision
+ */
+typedef basic_sparse_pca<float> fsparse_pca;
+
+} //stats
@@ -0,0 +1,218 @@
+#pragma once
+/**
+ * @file thread_pool.h
+ * @brief A thread pool shared by the parallel parts of libpca
+ */
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include <future>
+
+namespace stats {
+/**
+ * @brief A fixed-size work-stealing thread pool. The thread calling
+ * 	parallel_for always takes part in the work, so a pool of num_threads
+ * 	threads runs num_threads-1 worker threads and nested calls cannot
+ * 	deadlock. Each worker has its own task deque: tasks spawned by a worker
+ * 	are pushed to and popped from the back of its deque while idle workers
+ * 	steal from the front of other deques. Other threads push to a shared queue
+ */
+class thread_pool {
+public:
+	/**
+	 * @brief Constructor
+	 * @param num_threads The number of threads working on a parallel loop
+	 * 	including the calling thread
+	 * @param cpus The CPUs the worker threads are pinned to in a round-robin
+	 * 	fashion. An empty vector leaves the affinity to the operating system.
+	 * 	Pinning is only supported on Linux and ignored elsewhere
+	 * @throws std::invalid_argument if num_threads is smaller than one or
+	 * 	one of the cpus is negative
+	 */
+	explicit thread_pool(long num_threads, const std::vector<long>& cpus=std::vector<long>());
+	/**
+	 * @brief Destructor. Finishes all queued tasks and joins the worker threads
+	 */
+	~thread_pool();
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+	/**
+	 * @brief Returns the number of threads working on a parallel loop
+	 * @return The number of threads
+	 */
+	long get_num_threads() const;
+	/**
+	 * @brief Returns the CPUs the worker threads are pinned to
+	 * @return The CPUs
+	 */
+	const std::vector<long>& get_affinity() const;
+	/**
+	 * @brief Sets the number of threads the BLAS library may use for
+	 * 	matrix operations that libpca does not parallelize itself while
+	 * 	this pool is in use. Within parallel loops BLAS runs single-threaded
+	 * @param num_threads The number of BLAS threads. Zero leaves the BLAS
+	 * 	setting untouched. Default is the number of threads of the pool
+	 * @throws std::invalid_argument if num_threads is negative
+	 */
+	void set_blas_num_threads(long num_threads);
+	/**
+	 * @brief Returns the number of threads the BLAS library may use
+	 * @return The number of BLAS threads
+	 */
+	long get_blas_num_threads() const;
+	/**
+	 * @brief Calls function(first, last) for consecutive chunks [first, last)
+	 * 	of at most grain items covering [begin, end). The chunks depend on
+	 * 	grain only and not on the number of threads. Returns when all
+	 * 	chunks are done. The first exception thrown by function is rethrown
+	 * @param begin The first item
+	 * @param end One past the last item
+	 * @param grain The maximum number of items per chunk
+	 * @param function The function called for each chunk
+	 */
+	template<typename Function>
+	void parallel_for(long begin, long end, long grain, const Function& function) {
+		if (end<=begin) return;
+		grain = std::max(grain, 1L);
+		const long num_chunks = (end - begin + grain - 1) / grain;
+		run_chunks_(num_chunks, [&](long chunk) {
+			const long first = begin + chunk * grain;
+			function(first, std::min(first + grain, end));
+		});
+	}
+	/**
+	 * @brief Calls function(index) for each index of costs, one task per
+	 * 	index, starting with the largest cost. Ordering heterogeneous work
+	 * 	largest first keeps all threads busy until the end. Returns when
+	 * 	all indices are done. The first exception thrown by function is rethrown
+	 * @param costs The estimated cost of each index
+	 * @param function The function called for each index
+	 */
+	template<typename Function>
+	void parallel_for_largest_first(const std::vector<double>& costs, const Function& function) {
+		std::vector<long> order(costs.size());
+		for (size_t i=0; i<order.size(); ++i) order[i] = i;
+		std::stable_sort(order.begin(), order.end(), [&costs](long i, long j) { return costs[i] > costs[j]; });
+		run_chunks_(order.size(), [&](long chunk) {
+			function(order[chunk]);
+		});
+	}
+	/**
+	 * @brief Runs a task asynchronously on a worker thread. A pool of one
+	 * 	thread starts a worker thread for this purpose which does not take
+	 * 	part in parallel loops
+	 * @param task The task
+	 * @return A future that becomes ready when the task is done. It holds
+	 * 	the exception thrown by the task, if any
+	 */
+	std::future<void> submit(const std::function<void()>& task);
+	/**
+	 * @brief Returns the thread pool shared by default. Unless replaced by
+	 * 	set_default its number of threads equals the number of hardware threads
+	 * @return The default thread pool
+	 */
+	static std::shared_ptr<thread_pool> get_default();
+	/**
+	 * @brief Replaces the default thread pool. Must not be called while
+	 * 	the default thread pool is running parallel work
+	 * @param pool The new default thread pool
+	 * @throws std::invalid_argument if pool is empty
+	 */
+	static void set_default(const std::shared_ptr<thread_pool>& pool);
+	/**
+	 * @brief Returns the thread pool used by the calling thread. This is the
+	 * 	pool of the innermost scoped_thread_pool, the pool owning the calling
+	 * 	worker thread, or the default thread pool
+	 * @return The current thread pool
+	 */
+	static thread_pool& get_current();
+
+private:
+	friend class scoped_thread_pool;
+	struct task_queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+	long num_threads_;
+	long blas_num_threads_;
+	std::vector<long> cpus_;
+	bool stop_;
+	std::vector<std::thread> workers_;
+	std::vector<std::unique_ptr<task_queue>> queues_;
+	std::atomic<long> num_pending_;
+	std::mutex mutex_;
+	std::condition_variable condition_;
+	void run_worker_(long index);
+	void run_chunks_(long num_chunks, const std::function<void(long)>& function);
+	void push_(const std::function<void()>& task);
+	bool try_pop_(long index, std::function<void()>& task);
+};
+/**
+ * @brief Makes a thread pool the current pool of the calling thread
+ * 	for the lifetime of this object
+ */
+class scoped_thread_pool {
+public:
+	/**
+	 * @brief Constructor
+	 * @param pool The thread pool. An empty pointer keeps the current pool
+	 */
+	explicit scoped_thread_pool(const std::shared_ptr<thread_pool>& pool);
+	/**
+	 * @brief Destructor. Restores the previous current pool
+	 */
+	~scoped_thread_pool();
+	scoped_thread_pool(const scoped_thread_pool&) = delete;
+	scoped_thread_pool& operator=(const scoped_thread_pool&) = delete;
+
+private:
+	std::shared_ptr<thread_pool> pool_;
+	thread_pool* previous_;
+};
+
+namespace utils {
+/**
+ * @brief Sets the number of threads of the BLAS library Armadillo uses.
+ * 	Supported are OpenBLAS, MKL and BLIS. Note that this setting is process-wide
+ * @param num_threads The number of threads
+ * @return Whether a supported BLAS library was found
+ */
+bool set_blas_num_threads(long num_threads);
+/**
+ * @brief Returns the number of threads of the BLAS library Armadillo uses
+ * @return The number of threads or zero if no supported BLAS library was found
+ */
+long get_blas_num_threads();
+/**
+ * @brief Sets the number of BLAS threads for the lifetime of this object.
+ * 	The setting is process-wide, so overlapping scopes on several threads
+ * 	share it: the first one saves the previous number, each one sets its
+ * 	own and the last one to end restores the saved number
+ */
+class scoped_blas_threads {
+public:
+	/**
+	 * @brief Constructor
+	 * @param num_threads The number of threads. Zero leaves the setting untouched
+	 */
+	explicit scoped_blas_threads(long num_threads);
+	/**
+	 * @brief Destructor. Restores the saved number of BLAS threads if no
+	 * 	other scope is active
+	 */
+	~scoped_blas_threads();
+	scoped_blas_threads(const scoped_blas_threads&) = delete;
+	scoped_blas_threads& operator=(const scoped_blas_threads&) = delete;
+
+private:
+	bool is_active_;
+};
+
+} //utils
+} //stats
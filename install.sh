@@ -28,7 +28,7 @@ mkdir -p $dir
 mkdir -p $inc_dir
 mkdir -p $lib_dir
 
-cp -v include/pca.h $inc_dir
+cp -v include/*.h $inc_dir
 cp -v build/libpca.so.$version $lib_dir
 rm -f $lib_dir/libpca.so
 ln -sv $lib_dir/libpca.so.$version $lib_dir/libpca.so
@@ -0,0 +1,392 @@
+/**
+ * @file kernel_pca.cpp
+ * @brief Kernel principal component analysis using the Nystroem approximation
+ */
+#include "kernel_pca.h"
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace stats {
+
+const long kernel_block_records = 256;
+const double landmark_rank_tolerance = 1e-10;
+
+template<typename T>
+basic_kernel_pca<T>::basic_kernel_pca()
+	: num_vars_(0),
+	  num_records_(0),
+	  record_buffer_(1000),
+	  kernel_("rbf"),
+	  gamma_(0),
+	  degree_(3),
+	  coef0_(1),
+	  num_landmarks_(100),
+	  landmark_seed_(1),
+	  num_retained_(0),
+	  energy_(0)
+{}
+
+template<typename T>
+basic_kernel_pca<T>::basic_kernel_pca(long num_vars)
+	: num_vars_(num_vars),
+	  num_records_(0),
+	  record_buffer_(1000),
+	  kernel_("rbf"),
+	  gamma_(0),
+	  degree_(3),
+	  coef0_(1),
+	  num_landmarks_(100),
+	  landmark_seed_(1),
+	  num_retained_(0),
+	  energy_(0),
+	  data_(record_buffer_, num_vars_)
+{
+	assert_num_vars_();
+}
+
+template<typename T>
+basic_kernel_pca<T>::~basic_kernel_pca()
+{}
+
+template<typename T>
+void basic_kernel_pca<T>::assert_num_vars_() const {
+	if (num_vars_ < 1)
+		throw std::invalid_argument("Number of variables smaller than one.");
+}
+
+template<typename T>
+void basic_kernel_pca<T>::assert_solved_() const {
+	if (eigvec_.n_elem==0)
+		throw std::logic_error("Kernel PCA has not been solved.");
+}
+
+template<typename T>
+void basic_kernel_pca<T>::resize_data_if_needed_() {
+	if (num_records_ == record_buffer_) {
+		record_buffer_ += record_buffer_;
+		data_.resize(record_buffer_, num_vars_);
+	}
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_num_variables(long num_vars) {
+	num_vars_ = num_vars;
+	assert_num_vars_();
+	num_records_ = 0;
+	data_.set_size(record_buffer_, num_vars_);
+	eigvec_.reset();
+}
+
+template<typename T>
+long basic_kernel_pca<T>::get_num_variables() const {
+	return num_vars_;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::add_record(const std::vector<T>& record) {
+	assert_num_vars_();
+
+	if (num_vars_ != long(record.size()))
+		throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+	// a single non-finite value would spread to the whole kernel matrix
+	for (long j=0; j<num_vars_; ++j) {
+		if (!std::isfinite(record[j]))
+			throw std::domain_error(utils::join("Record has a non-finite value at: ", j));
+	}
+
+	resize_data_if_needed_();
+	arma::Row<T> row(&record.front(), record.size());
+	data_.row(num_records_) = std::move(row);
+	++num_records_;
+}
+
+template<typename T>
+std::vector<T> basic_kernel_pca<T>::get_record(long record_index) const {
+	if (record_index<0 || record_index>=num_records_)
+		throw std::range_error(utils::join("Index out of range: ", record_index));
+	return std::move(utils::extract_row_vector(data_, record_index));
+}
+
+template<typename T>
+long basic_kernel_pca<T>::get_num_records() const {
+	return num_records_;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_kernel(const std::string& kernel) {
+	if (kernel!="rbf" && kernel!="polynomial")
+		throw std::invalid_argument(utils::join("No such kernel available: ", kernel));
+	kernel_ = kernel;
+}
+
+template<typename T>
+std::string basic_kernel_pca<T>::get_kernel() const {
+	return kernel_;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_gamma(double gamma) {
+	if (gamma < 0)
+		throw std::invalid_argument("Kernel parameter gamma is negative.");
+	gamma_ = gamma;
+}
+
+template<typename T>
+double basic_kernel_pca<T>::get_gamma() const {
+	return gamma_;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_degree(long degree) {
+	if (degree < 1)
+		throw std::invalid_argument("Degree smaller than one.");
+	degree_ = degree;
+}
+
+template<typename T>
+long basic_kernel_pca<T>::get_degree() const {
+	return degree_;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_coef0(double coef0) {
+	coef0_ = coef0;
+}
+
+template<typename T>
+double basic_kernel_pca<T>::get_coef0() const {
+	return coef0_;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_num_landmarks(long num_landmarks, long seed) {
+	if (num_landmarks < 2)
+		throw std::invalid_argument("Number of landmarks smaller than two.");
+	num_landmarks_ = num_landmarks;
+	landmark_seed_ = seed;
+}
+
+template<typename T>
+long basic_kernel_pca<T>::get_num_landmarks() const {
+	return num_landmarks_;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_num_threads(long num_threads) {
+	thread_pool_ = std::make_shared<thread_pool>(num_threads);
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_thread_pool(const std::shared_ptr<thread_pool>& pool) {
+	thread_pool_ = pool;
+}
+
+template<typename T>
+std::shared_ptr<thread_pool> basic_kernel_pca<T>::get_thread_pool() const {
+	return thread_pool_ ? thread_pool_ : thread_pool::get_default();
+}
+
+template<typename T>
+arma::Mat<double> basic_kernel_pca<T>::make_kernel_matrix_(const arma::Mat<double>& records) const {
+	const double gamma = gamma_>0 ? gamma_ : 1. / num_vars_;
+	arma::Mat<double> kernel = records * landmarks_.t();
+	if (kernel_=="polynomial") {
+		for (long i=0; i<long(kernel.n_elem); ++i)
+			kernel[i] = std::pow(gamma * kernel[i] + coef0_, double(degree_));
+		return std::move(kernel);
+	}
+	// |x - y|^2 = |x|^2 + |y|^2 - 2 x^T y
+	std::vector<double> record_norms(records.n_rows, 0.);
+	std::vector<double> landmark_norms(landmarks_.n_rows, 0.);
+	for (long j=0; j<num_vars_; ++j) {
+		for (long i=0; i<long(records.n_rows); ++i)
+			record_norms[i] += records(i, j) * records(i, j);
+		for (long i=0; i<long(landmarks_.n_rows); ++i)
+			landmark_norms[i] += landmarks_(i, j) * landmarks_(i, j);
+	}
+	for (long j=0; j<long(kernel.n_cols); ++j) {
+		for (long i=0; i<long(kernel.n_rows); ++i) {
+			const double distance = record_norms[i] + landmark_norms[j] - 2 * kernel(i, j);
+			kernel(i, j) = std::exp(-gamma * std::max(0., distance));
+		}
+	}
+	return std::move(kernel);
+}
+
+template<typename T>
+arma::Mat<double> basic_kernel_pca<T>::make_features_(const arma::Mat<double>& records) const {
+	return std::move( make_kernel_matrix_(records) * feature_map_ );
+}
+
+template<typename T>
+void basic_kernel_pca<T>::solve() {
+	assert_num_vars_();
+
+	if (num_records_ < 2)
+		throw std::logic_error("Number of records smaller than two.");
+
+	const scoped_thread_pool scope(thread_pool_);
+	thread_pool& pool = thread_pool::get_current();
+
+	// landmarks are sampled without replacement and kept in record order
+	const long num_landmarks = std::min(num_landmarks_, num_records_);
+	std::vector<long> indices(num_records_);
+	std::iota(indices.begin(), indices.end(), 0L);
+	std::mt19937 generator(landmark_seed_);
+	std::shuffle(indices.begin(), indices.end(), generator);
+	std::sort(indices.begin(), indices.begin() + num_landmarks);
+	landmarks_.set_size(num_landmarks, num_vars_);
+	for (long i=0; i<num_landmarks; ++i)
+		for (long j=0; j<num_vars_; ++j)
+			landmarks_(i, j) = data_(indices[i], j);
+
+	// the feature map is K_mm^{-1/2} restricted to the numerical rank of K_mm
+	arma::Col<double> landmark_eigval;
+	arma::Mat<double> landmark_eigvec;
+	arma::eig_sym(landmark_eigval, landmark_eigvec, make_kernel_matrix_(landmarks_));
+	const double max_eigval = landmark_eigval(num_landmarks - 1);
+	const double tolerance = max_eigval * landmark_rank_tolerance;
+	long rank = 0;
+	while (rank<num_landmarks && landmark_eigval(num_landmarks - 1 - rank) > tolerance)
+		++rank;
+	if (rank==0)
+		throw std::runtime_error("Landmark kernel matrix is zero.");
+	feature_map_.set_size(num_landmarks, rank);
+	for (long k=0; k<rank; ++k) {
+		const long source = num_landmarks - 1 - k;
+		feature_map_.col(k) = landmark_eigvec.col(source) / std::sqrt(landmark_eigval(source));
+	}
+
+	arma::Mat<double> features(num_records_, rank);
+	{
+		const utils::scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+		pool.parallel_for(0, num_records_, kernel_block_records, [&](long first, long last) {
+			arma::Mat<double> block(last - first, num_vars_);
+			for (long i=first; i<last; ++i)
+				for (long j=0; j<num_vars_; ++j)
+					block(i - first, j) = data_(i, j);
+			features.rows(first, last - 1) = make_features_(block);
+		});
+	}
+
+	feature_mean_ = utils::compute_column_means(features);
+	utils::remove_column_means(features, feature_mean_);
+	const arma::Mat<double> cov_mat = utils::make_covariance_matrix(features);
+
+	arma::Col<double> eigval;
+	arma::Mat<double> eigvec;
+	arma::eig_sym(eigval, eigvec, cov_mat);
+	eigval_.set_size(rank);
+	eigvec_.set_size(rank, rank);
+	energy_ = 0;
+	for (long k=0; k<rank; ++k) {
+		const long source = rank - 1 - k;
+		eigval_(k) = std::max(0., eigval(source));
+		eigvec_.col(k) = eigvec.col(source);
+		energy_ += eigval_(k);
+	}
+	utils::enforce_positive_sign_by_column(eigvec_);
+	if (energy_ > 0) eigval_ /= energy_;
+
+	princomp_ = arma::conv_to<arma::Mat<T>>::from(features * eigvec_);
+	num_retained_ = rank;
+}
+
+template<typename T>
+void basic_kernel_pca<T>::set_num_retained(long num_retained) {
+	if (num_retained<=0 || num_retained>get_num_components())
+		throw std::range_error(utils::join("Value out of range: ", num_retained));
+	num_retained_ = num_retained;
+}
+
+template<typename T>
+long basic_kernel_pca<T>::get_num_retained() const {
+	return num_retained_;
+}
+
+template<typename T>
+long basic_kernel_pca<T>::get_num_components() const {
+	return eigval_.n_elem;
+}
+
+template<typename T>
+T basic_kernel_pca<T>::get_energy() const {
+	return energy_;
+}
+
+template<typename T>
+T basic_kernel_pca<T>::get_eigenvalue(long eigen_index) const {
+	if (eigen_index<0 || eigen_index>=get_num_components())
+		throw std::range_error(utils::join("Index out of range: ", eigen_index));
+	return eigval_(eigen_index);
+}
+
+template<typename T>
+std::vector<T> basic_kernel_pca<T>::get_eigenvalues() const {
+	return std::vector<T>(eigval_.memptr(), eigval_.memptr() + eigval_.n_elem);
+}
+
+template<typename T>
+std::vector<T> basic_kernel_pca<T>::get_principal(long eigen_index) const {
+	if (eigen_index<0 || eigen_index>=get_num_components())
+		throw std::range_error(utils::join("Index out of range: ", eigen_index));
+	return std::move(utils::extract_column_vector(princomp_, eigen_index));
+}
+
+template<typename T>
+std::vector<T> basic_kernel_pca<T>::to_principal_space(const std::vector<T>& record) const {
+	assert_solved_();
+	if (num_vars_ != long(record.size()))
+		throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+	arma::Mat<double> row(1, num_vars_);
+	for (long j=0; j<num_vars_; ++j)
+		row(0, j) = record[j];
+	arma::Mat<double> features = make_features_(row);
+	for (long k=0; k<long(features.n_cols); ++k)
+		features(0, k) -= feature_mean_(k);
+	const arma::Mat<double> projected = features * eigvec_.cols(0, num_retained_ - 1);
+	std::vector<T> result(num_retained_);
+	for (long k=0; k<num_retained_; ++k)
+		result[k] = projected(0, k);
+	return std::move(result);
+}
+
+template<typename T>
+std::vector<std::vector<T>> basic_kernel_pca<T>::to_principal_space(const std::vector<std::vector<T>>& records) const {
+	assert_solved_();
+	const long num_records = records.size();
+	for (const auto& record : records) {
+		if (num_vars_ != long(record.size()))
+			throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+	}
+
+	std::vector<std::vector<T>> result(num_records);
+	const scoped_thread_pool scope(thread_pool_);
+	thread_pool& pool = thread_pool::get_current();
+	const utils::scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+	const arma::Mat<double> retained = eigvec_.cols(0, num_retained_ - 1);
+
+	pool.parallel_for(0, num_records, kernel_block_records, [&](long first, long last) {
+		arma::Mat<double> block(last - first, num_vars_);
+		for (long i=first; i<last; ++i)
+			for (long j=0; j<num_vars_; ++j)
+				block(i - first, j) = records[i][j];
+		arma::Mat<double> features = make_features_(block);
+		for (long k=0; k<long(features.n_cols); ++k)
+			features.col(k) -= feature_mean_(k);
+		const arma::Mat<double> projected = features * retained;
+		for (long i=first; i<last; ++i) {
+			result[i].resize(num_retained_);
+			for (long k=0; k<num_retained_; ++k)
+				result[i][k] = projected(i - first, k);
+		}
+	});
+	return std::move(result);
+}
+
+template class basic_kernel_pca<float>;
+template class basic_kernel_pca<double>;
+
+} //stats
@@ -0,0 +1,180 @@
+/**
+ * @file memory_resource.cpp
+ * @brief Memory resources for the large buffers of libpca
+ */
+#include "memory_resource.h"
+#include <new>
+#include <cstdlib>
+#include <algorithm>
+
+namespace stats {
+
+namespace {
+
+class heap_resource : public memory_resource {
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) {
+		void* memory = nullptr;
+		if (posix_memalign(&memory, std::max(alignment, sizeof(void*)), std::max<std::size_t>(bytes, 1)) != 0)
+			throw std::bad_alloc();
+		return memory;
+	}
+	void do_deallocate(void* memory, std::size_t, std::size_t) {
+		std::free(memory);
+	}
+	bool do_is_equal(const memory_resource& other) const {
+		return dynamic_cast<const heap_resource*>(&other) != nullptr;
+	}
+};
+
+} //anonymous
+
+memory_resource::~memory_resource() {}
+
+void* memory_resource::allocate(std::size_t bytes, std::size_t alignment) {
+	return do_allocate(bytes, alignment);
+}
+
+void memory_resource::deallocate(void* memory, std::size_t bytes, std::size_t alignment) {
+	do_deallocate(memory, bytes, alignment);
+}
+
+bool memory_resource::is_equal(const memory_resource& other) const {
+	return this==&other || do_is_equal(other);
+}
+
+bool memory_resource::do_is_equal(const memory_resource& other) const {
+	return this==&other;
+}
+
+std::shared_ptr<memory_resource> memory_resource::get_default() {
+	static const std::shared_ptr<memory_resource> resource = std::make_shared<heap_resource>();
+	return resource;
+}
+
+arena_resource::arena_resource(std::size_t chunk_bytes, const std::shared_ptr<memory_resource>& upstream)
+	: chunk_bytes_(std::max<std::size_t>(chunk_bytes, memory_block_alignment)),
+	  upstream_(upstream ? upstream : memory_resource::get_default()),
+	  offset_(0),
+	  bytes_allocated_(0),
+	  bytes_reserved_(0)
+{}
+
+arena_resource::~arena_resource() {
+	release();
+}
+
+void arena_resource::release() {
+	std::lock_guard<std::mutex> lock(mutex_);
+	for (auto& c : chunks_)
+		upstream_->deallocate(c.memory, c.bytes, memory_block_alignment);
+	chunks_.clear();
+	offset_ = 0;
+	bytes_allocated_ = 0;
+	bytes_reserved_ = 0;
+}
+
+std::size_t arena_resource::get_bytes_allocated() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return bytes_allocated_;
+}
+
+std::size_t arena_resource::get_bytes_reserved() const {
+	std::lock_guard<std::mutex> lock(mutex_);
+	return bytes_reserved_;
+}
+
+void* arena_resource::do_allocate(std::size_t bytes, std::size_t alignment) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	alignment = std::max(alignment, std::size_t(1));
+	if (!chunks_.empty()) {
+		const chunk& last = chunks_.back();
+		const std::size_t address = reinterpret_cast<std::size_t>(last.memory) + offset_;
+		const std::size_t padding = (alignment - address % alignment) % alignment;
+		if (offset_ + padding + bytes <= last.bytes) {
+			offset_ += padding + bytes;
+			bytes_allocated_ += bytes;
+			return last.memory + offset_ - bytes;
+		}
+	}
+	// a new chunk is aligned to at least memory_block_alignment
+	const std::size_t chunk_bytes = std::max(chunk_bytes_, bytes + alignment);
+	chunk c;
+	c.memory = static_cast<char*>(upstream_->allocate(chunk_bytes, std::max(alignment, memory_block_alignment)));
+	c.bytes = chunk_bytes;
+	chunks_.push_back(c);
+	bytes_reserved_ += chunk_bytes;
+	offset_ = bytes;
+	bytes_allocated_ += bytes;
+	return c.memory;
+}
+
+void arena_resource::do_deallocate(void*, std::size_t, std::size_t) {}
+
+memory_block::memory_block()
+	: memory_(nullptr),
+	  bytes_(0),
+	  alignment_(memory_block_alignment)
+{}
+
+memory_block::memory_block(const std::shared_ptr<memory_resource>& resource, std::size_t bytes, std::size_t alignment)
+	: resource_(resource ? resource : memory_resource::get_default()),
+	  memory_(resource_->allocate(bytes, alignment)),
+	  bytes_(bytes),
+	  alignment_(alignment)
+{}
+
+memory_block::~memory_block() {
+	reset();
+}
+
+memory_block::memory_block(const memory_block&)
+	: memory_(nullptr),
+	  bytes_(0),
+	  alignment_(memory_block_alignment)
+{}
+
+memory_block::memory_block(memory_block&& other)
+	: resource_(std::move(other.resource_)),
+	  memory_(other.memory_),
+	  bytes_(other.bytes_),
+	  alignment_(other.alignment_)
+{
+	other.memory_ = nullptr;
+	other.bytes_ = 0;
+}
+
+memory_block& memory_block::operator=(const memory_block&) {
+	return *this;
+}
+
+memory_block& memory_block::operator=(memory_block&& other) {
+	if (this != &other) {
+		reset();
+		resource_ = std::move(other.resource_);
+		memory_ = other.memory_;
+		bytes_ = other.bytes_;
+		alignment_ = other.alignment_;
+		other.memory_ = nullptr;
+		other.bytes_ = 0;
+	}
+	return *this;
+}
+
+void* memory_block::get() const {
+	return memory_;
+}
+
+std::size_t memory_block::size() const {
+	return bytes_;
+}
+
+void memory_block::reset() {
+	if (memory_)
+		resource_->deallocate(memory_, bytes_, alignment_);
+	memory_ = nullptr;
+	bytes_ = 0;
+	resource_.reset();
+}
+
+} //stats
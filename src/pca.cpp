@@ -3,34 +3,62 @@
  * @brief Principal Component Analysis
  */
 #include "pca.h"
+#include "simd.h"
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
 #include <random>
+#include <atomic>
+#include <mutex>
 
 namespace stats {
 
-pca::pca()
+const long projection_block_records = 256;
+const long missing_mask_bits = 64;
+const long tsqr_block_records = 4096;
+
+template<typename T>
+basic_pca<T>::basic_pca()
 	: num_vars_(0),
 	  num_records_(0),
 	  record_buffer_(1000),
 	  solver_("dc"),
 	  do_normalize_(false),
 	  do_bootstrap_(false),
+	  do_concurrent_ingestion_(false),
+	  memory_placement_("default"),
+	  use_huge_pages_(false),
 	  num_bootstraps_(10),
 	  bootstrap_seed_(1),
 	  num_retained_(1),
-	  energy_(1)
-{}
+	  em_max_iterations_(500),
+	  em_tolerance_(1e-8),
+	  em_seed_(1),
+	  num_missing_(0),
+	  energy_(1),
+	  time_budget_(0)
+{
+	publish_model_();
+}
 
-pca::pca(long num_vars)
+template<typename T>
+basic_pca<T>::basic_pca(long num_vars)
 	: num_vars_(num_vars),
 	  num_records_(0),
 	  record_buffer_(1000),
 	  solver_("dc"),
 	  do_normalize_(false),
 	  do_bootstrap_(false),
+	  do_concurrent_ingestion_(false),
+	  memory_placement_("default"),
+	  use_huge_pages_(false),
 	  num_bootstraps_(10),
 	  bootstrap_seed_(1),
 	  num_retained_(num_vars_),
+	  em_max_iterations_(500),
+	  em_tolerance_(1e-8),
+	  em_seed_(1),
+	  num_missing_(0),
 	  data_(record_buffer_, num_vars_),
 	  energy_(1),
 	  energy_boot_(num_bootstraps_),
@@ -40,16 +68,19 @@ pca::pca(long num_vars)
 	  proj_eigvec_(num_vars_, num_vars_),
 	  princomp_(record_buffer_, num_vars_),
 	  mean_(num_vars_),
-	  sigma_(num_vars_)
+	  sigma_(num_vars_),
+	  time_budget_(0)
 {
 	assert_num_vars_();
 	initialize_();
 }
 
-pca::~pca()
+template<typename T>
+basic_pca<T>::~basic_pca()
 {}
 
-bool pca::operator==(const pca& other) {
+template<typename T>
+bool basic_pca<T>::operator==(const basic_pca& other) {
 	const double eps = 1e-5;
 	if (num_vars_ == other.num_vars_ &&
 		num_records_ == other.num_records_ &&
@@ -74,20 +105,87 @@ bool pca::operator==(const pca& other) {
 		return false;
 }
 
-void pca::resize_data_if_needed_() {
-	if (num_records_ == record_buffer_) {
-		record_buffer_ += record_buffer_;
-		data_.resize(record_buffer_, num_vars_);
+template<typename T>
+void basic_pca<T>::resize_data_if_needed_(long num_new) {
+	// solve shrinks the data matrix to the records, so its rows are checked
+	if (num_records_ + num_new > long(data_.n_rows)) {
+		while (num_records_ + num_new > record_buffer_)
+			record_buffer_ += record_buffer_;
+		resize_data_(record_buffer_);
+	}
+}
+
+template<typename T>
+void basic_pca<T>::resize_data_(long num_rows) {
+	if (memory_resource_ && num_rows * num_vars_ > 0) {
+		memory_block block(memory_resource_, num_rows * num_vars_ * sizeof(T));
+		const scoped_thread_pool scope(thread_pool_);
+		utils::resize_placed(data_, num_rows, num_vars_, memory_placement_, use_huge_pages_, static_cast<T*>(block.get()));
+		data_block_ = std::move(block);
+	} else if (memory_placement_=="default" && !use_huge_pages_) {
+		move_to_resource_(data_, data_block_);
+		data_.resize(num_rows, num_vars_);
+	} else {
+		move_to_resource_(data_, data_block_);
+		const scoped_thread_pool scope(thread_pool_);
+		utils::resize_placed(data_, num_rows, num_vars_, memory_placement_, use_huge_pages_);
+	}
+}
+
+template<typename T>
+arma::Mat<T> basic_pca<T>::make_resource_matrix_(long num_rows, long num_cols, memory_block& block) const {
+	if (!memory_resource_ || num_rows * num_cols == 0)
+		return arma::Mat<T>(num_rows, num_cols);
+	block = memory_block(memory_resource_, num_rows * num_cols * sizeof(T));
+	return arma::Mat<T>(static_cast<T*>(block.get()), num_rows, num_cols, false, false);
+}
+
+template<typename T>
+arma::Mat<T> basic_pca<T>::copy_records_(memory_block& block) const {
+	if (!memory_resource_ && memory_placement_=="default" && !use_huge_pages_)
+		return data_.rows(0, num_records_ - 1);
+	// the copy is placed like the data matrix
+	if (memory_resource_)
+		block = memory_block(memory_resource_, num_records_ * num_vars_ * sizeof(T));
+	arma::Mat<T> records;
+	utils::resize_placed(records, num_records_, num_vars_, memory_placement_, use_huge_pages_, static_cast<T*>(block.get()));
+	records = data_.rows(0, num_records_ - 1);
+	return std::move(records);
+}
+
+template<typename T>
+void basic_pca<T>::move_to_resource_(arma::Mat<T>& matrix, memory_block& block) {
+	if (block.get()==nullptr && !memory_resource_) return;
+	if (block.get()!=nullptr && block.get()==matrix.memptr() && memory_resource_) return;
+	// the matrix does not own the memory of a block so it is copied out first
+	arma::Mat<T> copy = matrix;
+	matrix.reset();
+	if (memory_resource_ && copy.n_elem > 0) {
+		memory_block target(memory_resource_, copy.n_elem * sizeof(T));
+		std::copy(copy.begin(), copy.end(), static_cast<T*>(target.get()));
+		matrix = arma::Mat<T>(static_cast<T*>(target.get()), copy.n_rows, copy.n_cols, false, false);
+		block = std::move(target);
+	} else {
+		matrix = std::move(copy);
+		block.reset();
 	}
 }
 
-void pca::assert_num_vars_() {
+template<typename T>
+void basic_pca<T>::assert_num_vars_() {
 	if (num_vars_ < 2)
 		throw std::invalid_argument("Number of variables smaller than two.");
 }
 
-void pca::initialize_() {
-	data_.zeros();
+template<typename T>
+void basic_pca<T>::initialize_() {
+	if (memory_placement_=="default" && !use_huge_pages_) {
+		data_.zeros();
+	} else {
+		const long num_rows = data_.n_rows;
+		data_.reset();
+		resize_data_(num_rows);
+	}
 	eigval_.zeros();
 	eigvec_.zeros();
 	princomp_.zeros();
@@ -96,43 +194,203 @@ void pca::initialize_() {
 	eigval_boot_.zeros();
 	energy_boot_.zeros();
 	energy_.zeros();
+	publish_model_();
+}
+
+template<typename T>
+void basic_pca<T>::publish_model_() {
+	auto model = std::make_shared<pca_model<T>>();
+	model->eigvec = proj_eigvec_;
+	model->mean = mean_;
+	model->sigma = sigma_;
+	model->do_normalize = do_normalize_;
+	std::atomic_store(&model_, std::shared_ptr<const pca_model<T>>(std::move(model)));
 }
 
-void pca::set_num_variables(long num_vars) {
+template<typename T>
+std::shared_ptr<const pca_model<T>> basic_pca<T>::get_model() const {
+	return std::atomic_load(&model_);
+}
+
+template<typename T>
+void basic_pca<T>::set_num_variables(long num_vars) {
 	num_vars_ = num_vars;
 	assert_num_vars_();
 	num_retained_ = num_vars_;
-	data_.resize(record_buffer_, num_vars_);
+	resize_data_(record_buffer_);
 	eigval_.resize(num_vars_);
 	eigvec_.resize(num_vars_, num_vars_);
 	mean_.resize(num_vars_);
 	sigma_.resize(num_vars_);
 	eigval_boot_.resize(num_bootstraps_, num_vars_);
 	energy_boot_.resize(num_bootstraps_);
+	pending_records_.clear();
+	missing_mask_.clear();
+	weights_.clear();
+	num_missing_ = 0;
 	initialize_();
 }
 
-void pca::add_record(const std::vector<double>& record) {
+template<typename T>
+void basic_pca<T>::add_record(const std::vector<T>& record) {
+	add_record(record, 1);
+}
+
+template<typename T>
+void basic_pca<T>::add_record(const std::vector<T>& record, double weight) {
 	assert_num_vars_();
 
 	if (num_vars_ != long(record.size()))
 		throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+	if (!(weight > 0))
+		throw std::invalid_argument(utils::join("Weight is not positive: ", weight));
+
+	if (do_concurrent_ingestion_) {
+		pending_records_.append(record.data(), num_vars_, weight);
+		return;
+	}
 
 	resize_data_if_needed_();
-	arma::Row<double> row(&record.front(), record.size());
+	arma::Row<T> row(&record.front(), record.size());
 	data_.row(num_records_) = std::move(row);
+	mark_missing_(num_records_, record.data());
+	store_weight_(num_records_, weight);
 	++num_records_;
 }
 
-std::vector<double> pca::get_record(long record_index) const {
+template<typename T>
+void basic_pca<T>::store_weight_(long record_index, double weight) {
+	// weights are only stored once a record has a weight other than one
+	if (weights_.empty() && weight==1)
+		return;
+	weights_.resize(record_index, 1.);
+	weights_.push_back(weight);
+}
+
+template<typename T>
+void basic_pca<T>::scale_records_(arma::Mat<T>& data, bool inverse) const {
+	// scaling by the square roots makes the covariance of the records the weighted covariance
+	std::vector<T> factors(num_records_);
+	for (long i=0; i<num_records_; ++i)
+		factors[i] = T(inverse ? 1. / std::sqrt(weights_[i]) : std::sqrt(weights_[i]));
+	for (long j=0; j<long(data.n_cols); ++j) {
+		T* column = data.colptr(j);
+		for (long i=0; i<num_records_; ++i)
+			column[i] *= factors[i];
+	}
+}
+
+template<typename T>
+double basic_pca<T>::get_covariance_scale_() const {
+	// the covariance is normalized by the total weight minus one instead of the number of records minus one
+	if (weights_.empty())
+		return 1;
+	return double(num_records_ - 1) / (get_total_weight() - 1);
+}
+
+template<typename T>
+double basic_pca<T>::get_total_weight() const {
+	double total = num_records_ - long(weights_.size());
+	for (double weight : weights_)
+		total += weight;
+	return total;
+}
+
+template<typename T>
+void basic_pca<T>::mark_missing_(long record_index, const T* record) {
+	// the mask only grows up to the last record with a missing value
+	const long num_words = (num_vars_ + missing_mask_bits - 1) / missing_mask_bits;
+	for (long j=0; j<num_vars_; ++j) {
+		if (!std::isnan(record[j])) continue;
+		if (long(missing_mask_.size()) < (record_index + 1) * num_words)
+			missing_mask_.resize((record_index + 1) * num_words, 0);
+		missing_mask_[record_index * num_words + j / missing_mask_bits] |= std::uint64_t(1) << (j % missing_mask_bits);
+		++num_missing_;
+	}
+}
+
+template<typename T>
+std::vector<arma::uword> basic_pca<T>::get_missing_indices_() const {
+	// linear indices into the data matrix with one row per record
+	const long num_words = (num_vars_ + missing_mask_bits - 1) / missing_mask_bits;
+	const long num_masked = missing_mask_.size() / num_words;
+	std::vector<arma::uword> indices;
+	indices.reserve(num_missing_);
+	for (long i=0; i<num_masked; ++i) {
+		for (long j=0; j<num_vars_; ++j) {
+			if (missing_mask_[i * num_words + j / missing_mask_bits] >> (j % missing_mask_bits) & 1)
+				indices.push_back(j * num_records_ + i);
+		}
+	}
+	return std::move(indices);
+}
+
+template<typename T>
+long basic_pca<T>::get_num_missing() const {
+	return num_missing_;
+}
+
+template<typename T>
+bool basic_pca<T>::is_missing(long record_index, long var_index) const {
+	if (record_index<0 || record_index>=num_records_)
+		throw std::range_error(utils::join("Index out of range: ", record_index));
+	if (var_index<0 || var_index>=num_vars_)
+		throw std::range_error(utils::join("Index out of range: ", var_index));
+	const long num_words = (num_vars_ + missing_mask_bits - 1) / missing_mask_bits;
+	const long word = record_index * num_words + var_index / missing_mask_bits;
+	if (word >= long(missing_mask_.size()))
+		return false;
+	return missing_mask_[word] >> (var_index % missing_mask_bits) & 1;
+}
+
+template<typename T>
+void basic_pca<T>::set_do_concurrent_ingestion(bool do_concurrent_ingestion) {
+	if (do_concurrent_ingestion_ && !do_concurrent_ingestion)
+		flush_records();
+	do_concurrent_ingestion_ = do_concurrent_ingestion;
+}
+
+template<typename T>
+bool basic_pca<T>::get_do_concurrent_ingestion() const {
+	return do_concurrent_ingestion_;
+}
+
+template<typename T>
+void basic_pca<T>::flush_records() {
+	const auto chunks = pending_records_.take();
+	long num_pending = 0;
+	for (const auto& chunk : chunks)
+		num_pending += chunk.weights.size();
+	resize_data_if_needed_(num_pending);
+	for (const auto& chunk : chunks) {
+		const long num_rows = chunk.weights.size();
+		for (long i=0; i<num_rows; ++i) {
+			for (long j=0; j<num_vars_; ++j)
+				data_(num_records_, j) = chunk.values[i * num_vars_ + j];
+			mark_missing_(num_records_, &chunk.values[i * num_vars_]);
+			store_weight_(num_records_, chunk.weights[i]);
+			++num_records_;
+		}
+	}
+}
+
+template<typename T>
+std::vector<T> basic_pca<T>::get_record(long record_index) const {
 	return std::move(utils::extract_row_vector(data_, record_index));
 }
 
-void pca::set_do_normalize(bool do_normalize) {
+template<typename T>
+vector_view<T> basic_pca<T>::view_record(long record_index) const {
+	return utils::view_row(data_, record_index);
+}
+
+template<typename T>
+void basic_pca<T>::set_do_normalize(bool do_normalize) {
 	do_normalize_ = do_normalize;
 }
 
-void pca::set_do_bootstrap(bool do_bootstrap, long number, long seed) {
+template<typename T>
+void basic_pca<T>::set_do_bootstrap(bool do_bootstrap, long number, long seed) {
 	if (number < 10)
 		throw std::invalid_argument("Number of bootstraps smaller than ten.");
 
@@ -144,174 +402,707 @@ void pca::set_do_bootstrap(bool do_bootstrap, long number, long seed) {
 	energy_boot_.resize(num_bootstraps_);
 }
 
-void pca::set_solver(const std::string& solver) {
-	if (solver!="standard" && solver!="dc")
+template<typename T>
+void basic_pca<T>::set_solver(const std::string& solver) {
+	if (solver!="standard" && solver!="dc" && solver!="mixed" && solver!="em" && solver!="tsqr" && solver!="svd" && solver!="packed" && solver!="auto")
 		throw std::invalid_argument(utils::join("No such solver available: ", solver));
 	solver_ = solver;
 }
 
-void pca::solve() {
-	assert_num_vars_();
+template<typename T>
+void basic_pca<T>::set_em_iterations(long max_iterations, double tolerance, long seed) {
+	if (max_iterations < 1)
+		throw std::invalid_argument("Number of iterations smaller than one.");
+	if (tolerance < 0)
+		throw std::invalid_argument("Negative tolerance.");
+	em_max_iterations_ = max_iterations;
+	em_tolerance_ = tolerance;
+	em_seed_ = seed;
+}
 
-	if (num_records_ < 2)
-		throw std::logic_error("Number of records smaller than two.");
+template<typename T>
+long basic_pca<T>::get_em_iterations() const {
+	return em_max_iterations_;
+}
+
+template<typename T>
+void basic_pca<T>::set_num_threads(long num_threads) {
+	thread_pool_ = std::make_shared<thread_pool>(num_threads);
+}
+
+template<typename T>
+long basic_pca<T>::get_num_threads() const {
+	return get_thread_pool()->get_num_threads();
+}
+
+template<typename T>
+void basic_pca<T>::set_thread_pool(const std::shared_ptr<thread_pool>& pool) {
+	thread_pool_ = pool;
+}
+
+template<typename T>
+std::shared_ptr<thread_pool> basic_pca<T>::get_thread_pool() const {
+	return thread_pool_ ? thread_pool_ : thread_pool::get_default();
+}
+
+template<typename T>
+void basic_pca<T>::set_memory_placement(const std::string& placement, bool use_huge_pages) {
+	if (placement!="default" && placement!="first_touch" && placement!="interleave")
+		throw std::invalid_argument(utils::join("No such memory placement available: ", placement));
+	memory_placement_ = placement;
+	use_huge_pages_ = use_huge_pages;
+	if (num_vars_ > 0) resize_data_(data_.n_rows);
+}
+
+template<typename T>
+void basic_pca<T>::set_memory_resource(const std::shared_ptr<memory_resource>& resource) {
+	memory_resource_ = resource;
+	move_to_resource_(data_, data_block_);
+	move_to_resource_(princomp_, princomp_block_);
+}
+
+template<typename T>
+std::shared_ptr<memory_resource> basic_pca<T>::get_memory_resource() const {
+	return memory_resource_;
+}
 
-	data_.resize(num_records_, num_vars_);
+template<typename T>
+std::string basic_pca<T>::get_memory_placement() const {
+	return memory_placement_;
+}
 
-	mean_ = utils::compute_column_means(data_);
-	utils::remove_column_means(data_, mean_);
+template<typename T>
+bool basic_pca<T>::get_use_huge_pages() const {
+	return use_huge_pages_;
+}
 
-	sigma_ = utils::compute_column_rms(data_);
-	if (do_normalize_) utils::normalize_by_column(data_, sigma_);
+template<typename T>
+void basic_pca<T>::solve() {
+	assert_num_vars_();
+	flush_records();
 
-	arma::Col<double> eigval(num_vars_);
-	arma::Mat<double> eigvec(num_vars_, num_vars_);
+	if (num_records_ < 2)
+		throw std::logic_error("Number of records smaller than two.");
+
+	const auto start = std::chrono::steady_clock::now();
+	const auto deadline = time_budget_>0 ? start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_budget_)) : std::chrono::steady_clock::time_point::max();
+	check_cancelled_();
+
+	const scoped_thread_pool scope(thread_pool_);
+	const utils::scoped_blas_threads blas_threads(thread_pool::get_current().get_blas_num_threads());
+
+	chosen_solver_ = solver_=="auto" ? utils::choose_solver(num_records_, num_vars_, thread_pool::get_current().get_num_threads()) : solver_;
+	resize_data_(num_records_);
+	// the statistics, imputation and weighting work on a copy so the records stay as added
+	memory_block data_block;
+	arma::Mat<T> data = copy_records_(data_block);
+
+	// missing values are zero while the moments of the observed values are computed
+	const std::vector<arma::uword> missing = get_missing_indices_();
+	const bool is_weighted = !weights_.empty();
+	if (is_weighted) weights_.resize(num_records_, 1.);
+	std::vector<double> num_observed(num_vars_, get_total_weight());
+	for (arma::uword index : missing) {
+		data[index] = 0;
+		num_observed[index / num_records_] -= is_weighted ? weights_[index % num_records_] : 1;
+	}
+	for (long j=0; j<num_vars_; ++j) {
+		if (num_observed[j] <= 1)
+			throw std::runtime_error(utils::join("Variable has fewer than two observed values: ", j));
+	}
 
-	arma::Mat<double> cov_mat = utils::make_covariance_matrix(data_);
-	arma::eig_sym(eigval, eigvec, cov_mat, solver_.c_str());
+	if (is_weighted) {
+		mean_.set_size(num_vars_);
+		for (long j=0; j<num_vars_; ++j) {
+			double sum = 0;
+			for (long i=0; i<num_records_; ++i)
+				sum += weights_[i] * data(i, j);
+			mean_(j) = sum / num_observed[j];
+		}
+	} else {
+		mean_ = utils::compute_column_means(data);
+		if (!missing.empty()) {
+			for (long j=0; j<num_vars_; ++j)
+				mean_(j) *= T(num_records_ / num_observed[j]);
+		}
+	}
+	utils::remove_column_means(data, mean_);
+
+	for (arma::uword index : missing)
+		data[index] = 0;
+	if (is_weighted) scale_records_(data, false);
+	sigma_ = utils::compute_column_rms(data);
+	if (!missing.empty() || is_weighted) {
+		for (long j=0; j<num_vars_; ++j)
+			sigma_(j) *= T(std::sqrt((num_records_ - 1) / (num_observed[j] - 1)));
+	}
+	if (do_normalize_) utils::normalize_by_column(data, sigma_);
+	report_progress_("statistics", 1, -1);
+	check_cancelled_();
+
+	arma::Col<double> eigval;
+	arma::Mat<double> eigvec;
+	arma::Mat<double> scores;
+	double energy = solve_data_(data, eigval, eigvec, scores);
+	report_progress_("eigensolve", 1, -1);
+	check_cancelled_();
+
+	// em imputation: missing values are replaced by their reconstruction
+	// from the retained eigenvectors and the eigenproblem is solved again
+	const long num_imputed = std::min(num_retained_, long(eigval.n_elem));
+	for (long iter=0; !missing.empty() && num_imputed<num_vars_ && iter<em_max_iterations_; ++iter) {
+		const arma::uvec order = arma::sort_index(eigval, 1);
+		arma::Mat<T> basis(num_vars_, num_imputed);
+		for (long k=0; k<num_imputed; ++k)
+			basis.col(k) = arma::conv_to<arma::Col<T>>::from(eigvec.col(order(k)));
+		const arma::Mat<T> latent = data * basis;
+		double change = 0;
+		double norm = 0;
+		for (arma::uword index : missing) {
+			const long i = index % num_records_;
+			const long j = index / num_records_;
+			double value = 0;
+			for (long k=0; k<num_imputed; ++k)
+				value += double(latent(i, k)) * basis(j, k);
+			change += (value - data[index]) * (value - data[index]);
+			norm += value * value;
+			data[index] = value;
+		}
+		energy = solve_data_(data, eigval, eigvec, scores);
+		report_progress_("imputation", double(iter + 1) / em_max_iterations_, -1);
+		check_cancelled_();
+		if (change <= em_tolerance_ * em_tolerance_ * norm) break;
+	}
 	arma::uvec indices = arma::sort_index(eigval, 1);
 
-	for (long i=0; i<num_vars_; ++i) {
+	const long num_eigen = eigval.n_elem;
+	eigval_.set_size(num_eigen);
+	eigvec_.set_size(num_vars_, num_eigen);
+	for (long i=0; i<num_eigen; ++i) {
 		eigval_(i) = eigval(indices(i));
-		eigvec_.col(i) = eigvec.col(indices(i));
+		eigvec_.col(i) = arma::conv_to<arma::Col<T>>::from(eigvec.col(indices(i)));
 	}
 
 	utils::enforce_positive_sign_by_column(eigvec_);
 	proj_eigvec_ = eigvec_;
 
-	princomp_ = data_ * eigvec_;
+	// the principal components are computed directly into the memory resource
+	memory_block block;
+	arma::Mat<T> princomp = make_resource_matrix_(num_records_, num_eigen, block);
+	if (scores.n_elem) {
+		// the svd solver yields the principal components up to the sign flips
+		for (long i=0; i<num_eigen; ++i) {
+			double dot = 0;
+			for (long j=0; j<num_vars_; ++j)
+				dot += eigvec_(j, i) * eigvec(j, indices(i));
+			arma::Col<double> column = scores.col(indices(i));
+			if (dot < 0) column *= -1;
+			princomp.col(i) = arma::conv_to<arma::Col<T>>::from(column);
+		}
+	} else {
+		princomp = data * eigvec_;
+	}
+	if (is_weighted) scale_records_(princomp, true);
+	princomp_.reset();
+	princomp_ = std::move(princomp);
+	princomp_block_ = std::move(block);
 
-	energy_(0) = arma::sum(eigval_);
+	// the em solver computes the retained eigenvalues only so the energy is the trace
+	energy_(0) = energy;
 	eigval_ *= 1./energy_(0);
 
-	if (do_bootstrap_) bootstrap_eigenvalues_();
+	// weighted records are resampled together with their weights
+	if (do_bootstrap_) bootstrap_eigenvalues_(data, deadline);
+
+	publish_model_();
+}
+
+template<typename T>
+double basic_pca<T>::solve_data_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec, arma::Mat<double>& scores) const {
+	const double scale = get_covariance_scale_();
+	scores.reset();
+	if (chosen_solver_=="em") {
+		const double energy = solve_em_(data, eigval, eigvec);
+		eigval *= scale;
+		return energy * scale;
+	}
+	if (chosen_solver_=="tsqr") {
+		solve_tsqr_(data, eigval, eigvec);
+		eigval *= scale;
+		return arma::sum(eigval);
+	}
+	if (chosen_solver_=="svd") {
+		solve_svd_(data, eigval, eigvec, scores);
+		eigval *= scale;
+		return arma::sum(eigval);
+	}
+	if (chosen_solver_=="packed") {
+		arma::Col<double> packed = utils::make_packed_covariance_matrix(data);
+		if (scale!=1) packed *= scale;
+		report_progress_("covariance", 1, -1);
+		check_cancelled_();
+		utils::eig_sym_packed(eigval, eigvec, packed, num_vars_);
+		return arma::sum(eigval);
+	}
+	arma::Mat<double> cov_mat = utils::make_covariance_matrix(data);
+	if (scale!=1) cov_mat *= scale;
+	report_progress_("covariance", 1, -1);
+	check_cancelled_();
+	solve_eigenproblem_(eigval, eigvec, cov_mat);
+	return arma::sum(eigval);
+}
+
+template<typename T>
+std::future<void> basic_pca<T>::solve_async() {
+	return get_thread_pool()->submit([this]() { solve(); });
+}
+
+template<typename T>
+void basic_pca<T>::solve_eigenproblem_(arma::Col<double>& eigval, arma::Mat<double>& eigvec, const arma::Mat<double>& cov_mat) const {
+	if (chosen_solver_=="mixed") {
+		arma::Col<float> eigval_single;
+		arma::Mat<float> eigvec_single;
+		arma::eig_sym(eigval_single, eigvec_single, arma::conv_to<arma::Mat<float>>::from(cov_mat), "dc");
+		eigval = arma::conv_to<arma::Col<double>>::from(eigval_single);
+		eigvec = arma::conv_to<arma::Mat<double>>::from(eigvec_single);
+		utils::refine_symmetric_eigenpairs(eigval, eigvec, cov_mat);
+	} else {
+		arma::eig_sym(eigval, eigvec, cov_mat, chosen_solver_.c_str());
+	}
+}
+
+template<typename T>
+double basic_pca<T>::solve_em_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec) const {
+	const long num_records = data.n_rows;
+	const long num_vars = data.n_cols;
+	const long num_components = std::min(num_retained_, std::min(num_vars, num_records - 1));
+	// the energy is the trace of the covariance matrix
+	const arma::Col<T> rms = utils::compute_column_rms(data);
+	double energy = 0;
+	for (long j=0; j<num_vars; ++j)
+		energy += double(rms(j)) * rms(j);
+	const double sum_squares = energy * (num_records - 1);
+
+	std::mt19937 generator(em_seed_);
+	std::normal_distribution<double> distribution;
+	arma::Mat<double> loadings(num_vars, num_components);
+	for (long k=0; k<long(loadings.n_elem); ++k)
+		loadings[k] = distribution(generator);
+	double noise = energy / num_vars;
+	arma::Mat<double> identity(num_components, num_components);
+	identity.eye();
+
+	// Tipping and Bishop's em iteration for the loadings W and the noise variance
+	for (long iter=0; iter<em_max_iterations_; ++iter) {
+		check_cancelled_();
+		// E-step: latent means Y W M^-1 with M = W^T W + noise I
+		const arma::Mat<double> moment_inv = arma::inv_sympd(loadings.t() * loadings + identity * noise);
+		const arma::Mat<double> latent = arma::conv_to<arma::Mat<double>>::from(data * arma::conv_to<arma::Mat<T>>::from(loadings * moment_inv));
+		const arma::Mat<double> latent_moment = moment_inv * (noise * (num_records - 1)) + latent.t() * latent;
+		// M-step
+		const arma::Mat<double> cross = arma::conv_to<arma::Mat<double>>::from(data.t() * arma::conv_to<arma::Mat<T>>::from(latent));
+		const arma::Mat<double> next = cross * arma::inv_sympd(latent_moment);
+		noise = std::max(0., (sum_squares - arma::accu(next % cross)) / (double(num_records - 1) * num_vars));
+		const double change = arma::norm(next - loadings, "fro") / arma::norm(next, "fro");
+		loadings = next;
+		if (change < em_tolerance_) break;
+	}
+
+	// Rayleigh-Ritz on the converged subspace yields orthonormal eigenvectors
+	arma::Mat<double> basis;
+	arma::Mat<double> upper;
+	arma::qr_econ(basis, upper, loadings);
+	const arma::Mat<double> projected = arma::conv_to<arma::Mat<double>>::from(data * arma::conv_to<arma::Mat<T>>::from(basis));
+	arma::Mat<double> ritz_vec;
+	arma::eig_sym(eigval, ritz_vec, projected.t() * projected * (1./(num_records - 1)));
+	eigvec = basis * ritz_vec;
+	return energy;
 }
 
-void pca::bootstrap_eigenvalues_() {
-	std::srand(bootstrap_seed_);
+template<typename T>
+void basic_pca<T>::solve_tsqr_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec) const {
+	thread_pool& pool = thread_pool::get_current();
+	const utils::scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+
+	// the remainder is merged into the last block so every block has at least
+	// as many records as variables and each R factor is square, unless all
+	// records fit into a single block
+	const long num_records = data.n_rows;
+	const long block_records = std::max(tsqr_block_records, long(data.n_cols));
+	const long num_blocks = std::max(1L, num_records / block_records);
+	std::vector<arma::Mat<double>> factors(num_blocks);
+	pool.parallel_for(0, num_blocks, 1, [&](long first, long last) {
+		for (long b=first; b<last; ++b) {
+			const long begin = b * block_records;
+			const long end = b + 1 < num_blocks ? begin + block_records : num_records;
+			arma::Mat<double> q;
+			arma::qr_econ(q, factors[b], arma::conv_to<arma::Mat<double>>::from(data.rows(begin, end - 1)));
+		}
+	});
+	check_cancelled_();
+
+	// the tree reduction is fixed by the number of blocks so results do not depend on scheduling
+	for (long stride=1; stride<num_blocks; stride*=2) {
+		const long num_pairs = (num_blocks + 2 * stride - 1) / (2 * stride);
+		pool.parallel_for(0, num_pairs, 1, [&](long first, long last) {
+			for (long k=first; k<last; ++k) {
+				const long b = 2 * stride * k;
+				if (b + stride >= num_blocks) continue;
+				arma::Mat<double> q;
+				arma::Mat<double> r;
+				arma::qr_econ(q, r, arma::join_cols(factors[b], factors[b + stride]));
+				factors[b] = std::move(r);
+				factors[b + stride].reset();
+			}
+		});
+	}
 
-	arma::Col<double> eigval(num_vars_);
-	arma::Mat<double> dummy(num_vars_, num_vars_);
+	// X = Q R and R = U S V^T give X^T X = V S^2 V^T
+	arma::Mat<double> left;
+	arma::Col<double> singular;
+	arma::svd_econ(left, singular, eigvec, factors[0], "right");
+	eigval = singular % singular * (1./(num_records - 1));
+}
 
-	for (long b=0; b<num_bootstraps_; ++b) {
-		const arma::Mat<double> shuffle = utils::make_shuffled_matrix(data_);
+template<typename T>
+void basic_pca<T>::solve_svd_(const arma::Mat<T>& data, arma::Col<double>& eigval, arma::Mat<double>& eigvec, arma::Mat<double>& scores) const {
+	// X = U S V^T gives X^T X = V S^2 V^T and the projection X V = U S
+	arma::Col<double> singular;
+	arma::svd_econ(scores, singular, eigvec, arma::conv_to<arma::Mat<double>>::from(data), "both", "dc");
+	for (long k=0; k<long(singular.n_elem); ++k)
+		scores.col(k) *= singular(k);
+	eigval = singular % singular * (1./(long(data.n_rows) - 1));
+}
 
-		const arma::Mat<double> cov_mat = utils::make_covariance_matrix(shuffle);
-		arma::eig_sym(eigval, dummy, cov_mat, solver_.c_str());
-		eigval = arma::sort(eigval, 1);
+template<typename T>
+void basic_pca<T>::bootstrap_eigenvalues_(const arma::Mat<T>& data, const std::chrono::steady_clock::time_point& deadline) {
+	thread_pool& pool = thread_pool::get_current();
+	const utils::scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
 
-		energy_boot_(b) = arma::sum(eigval);
-		eigval *= 1./energy_boot_(b);
-		eigval_boot_.row(b) = eigval.t();
+	const long num_eigen = eigval_.n_elem;
+	const double scale = get_covariance_scale_();
+	eigval_boot_.resize(num_bootstraps_, num_eigen);
+	energy_boot_.resize(num_bootstraps_);
+	std::vector<char> completed(num_bootstraps_, 0);
+	std::atomic<long> num_completed(0);
+	std::mutex progress_mutex;
+
+	pool.parallel_for(0, num_bootstraps_, 1, [&, this](long first, long last) {
+		arma::Col<double> eigval(num_vars_);
+		arma::Mat<double> dummy(num_vars_, num_vars_);
+
+		for (long b=first; b<last; ++b) {
+			check_cancelled_();
+			if (std::chrono::steady_clock::now() >= deadline) return;
+			// each replicate has its own generator so results do not depend on scheduling
+			std::seed_seq seed{bootstrap_seed_, b};
+			std::mt19937 generator(seed);
+			const arma::Mat<T> shuffle = utils::make_shuffled_matrix(data, generator);
+
+			if (chosen_solver_=="em") {
+				energy_boot_(b) = solve_em_(shuffle, eigval, dummy);
+				eigval = arma::sort(eigval, 1);
+			} else if (chosen_solver_=="tsqr" || chosen_solver_=="svd") {
+				// the bootstrap needs the eigenvalues only
+				solve_tsqr_(shuffle, eigval, dummy);
+				eigval = arma::sort(eigval, 1);
+				energy_boot_(b) = arma::sum(eigval);
+			} else if (chosen_solver_=="packed") {
+				arma::Col<double> packed = utils::make_packed_covariance_matrix(shuffle);
+				utils::eig_sym_packed(eigval, dummy, packed, num_vars_);
+				eigval = arma::sort(eigval, 1);
+				energy_boot_(b) = arma::sum(eigval);
+			} else {
+				const arma::Mat<double> cov_mat = utils::make_covariance_matrix(shuffle);
+				solve_eigenproblem_(eigval, dummy, cov_mat);
+				eigval = arma::sort(eigval, 1);
+				energy_boot_(b) = arma::sum(eigval);
+			}
+			eigval *= 1./energy_boot_(b);
+			energy_boot_(b) *= scale;
+			eigval_boot_.row(b) = arma::conv_to<arma::Row<T>>::from(eigval);
+			completed[b] = 1;
+
+			std::lock_guard<std::mutex> lock(progress_mutex);
+			report_progress_("bootstrap", double(++num_completed) / num_bootstraps_, b);
+		}
+	});
+
+	if (num_completed < num_bootstraps_) {
+		arma::Col<T> energy_boot(num_completed);
+		arma::Mat<T> eigval_boot(num_completed, num_eigen);
+		for (long b=0, i=0; b<num_bootstraps_; ++b) {
+			if (!completed[b]) continue;
+			energy_boot(i) = energy_boot_(b);
+			eigval_boot.row(i) = eigval_boot_.row(b);
+			++i;
+		}
+		energy_boot_ = energy_boot;
+		eigval_boot_ = eigval_boot;
 	}
 }
 
-void pca::set_num_retained(long num_retained) {
+template<typename T>
+void basic_pca<T>::report_progress_(const std::string& stage, double fraction, long replicate) const {
+	if (progress_callback_) progress_callback_(stage, fraction, replicate);
+}
+
+template<typename T>
+void basic_pca<T>::check_cancelled_() const {
+	if (cancellation_token_.is_cancelled())
+		throw solve_cancelled();
+}
+
+template<typename T>
+void basic_pca<T>::set_progress_callback(const progress_callback& callback) {
+	progress_callback_ = callback;
+}
+
+template<typename T>
+void basic_pca<T>::set_cancellation_token(const cancellation_token& token) {
+	cancellation_token_ = token;
+}
+
+template<typename T>
+void basic_pca<T>::set_time_budget(double seconds) {
+	if (seconds < 0)
+		throw std::invalid_argument("Negative time budget.");
+	time_budget_ = seconds;
+}
+
+template<typename T>
+double basic_pca<T>::get_time_budget() const {
+	return time_budget_;
+}
+
+template<typename T>
+void basic_pca<T>::set_num_retained(long num_retained) {
 	if (num_retained<=0 || num_retained>num_vars_)
 		throw std::range_error(utils::join("Value out of range: ", num_retained));
 
 	num_retained_ = num_retained;
-	proj_eigvec_ = eigvec_.submat(0, 0, eigvec_.n_rows-1, num_retained_-1);
+	// the em solver may have computed fewer eigenvectors than are now retained
+	const long num_projected = std::min(num_retained_, long(eigvec_.n_cols));
+	proj_eigvec_ = eigvec_.submat(0, 0, eigvec_.n_rows-1, num_projected-1);
+	publish_model_();
 }
 
-std::vector<double> pca::to_principal_space(const std::vector<double>& data) const {
-	arma::Col<double> column(&data.front(), data.size());
-	column -= mean_;
-	if (do_normalize_) column /= sigma_;
-	const arma::Row<double> row(column.t() * proj_eigvec_);
-	return std::move(utils::extract_row_vector(row, 0));
+template<typename T>
+std::vector<T> basic_pca<T>::to_principal_space(const std::vector<T>& data) const {
+	const auto model = get_model();
+	arma::Col<T> column(&data.front(), data.size());
+	column -= model->mean;
+	if (model->do_normalize) column /= model->sigma;
+	const auto& kernels = utils::simd::get_kernels<T>();
+	std::vector<T> result(model->eigvec.n_cols);
+	for (long i=0; i<long(model->eigvec.n_cols); ++i)
+		result[i] = kernels.dot(model->eigvec.colptr(i), column.memptr(), column.n_elem);
+	return std::move(result);
 }
 
-std::vector<double> pca::to_variable_space(const std::vector<double>& data) const {
-	const arma::Row<double> row(&data.front(), data.size());
-	arma::Col<double> column(arma::trans(row * proj_eigvec_.t()));
-	if (do_normalize_) column %= sigma_;
-	column += mean_;
+template<typename T>
+std::vector<std::vector<T>> basic_pca<T>::to_principal_space(const std::vector<std::vector<T>>& records) const {
+	const auto model = get_model();
+	const long num_records = records.size();
+	const long num_vars = model->mean.n_elem;
+	for (const auto& record : records) {
+		if (num_vars != long(record.size()))
+			throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+	}
+
+	std::vector<std::vector<T>> result(num_records);
+	const scoped_thread_pool scope(thread_pool_);
+	thread_pool& pool = thread_pool::get_current();
+	const utils::scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+
+	pool.parallel_for(0, num_records, projection_block_records, [&](long first, long last) {
+		arma::Mat<T> block(last - first, num_vars);
+		for (long i=first; i<last; ++i)
+			for (long j=0; j<num_vars; ++j)
+				block(i - first, j) = records[i][j];
+		for (long j=0; j<num_vars; ++j) {
+			block.col(j) -= model->mean(j);
+			if (model->do_normalize) block.col(j) /= model->sigma(j);
+		}
+		const arma::Mat<T> projected = block * model->eigvec;
+		for (long i=first; i<last; ++i)
+			result[i] = utils::extract_row_vector(projected, i - first);
+	});
+	return std::move(result);
+}
+
+template<typename T>
+std::vector<T> basic_pca<T>::to_variable_space(const std::vector<T>& data) const {
+	const auto model = get_model();
+	const arma::Row<T> row(&data.front(), data.size());
+	arma::Col<T> column(arma::trans(row * model->eigvec.t()));
+	if (model->do_normalize) column %= model->sigma;
+	column += model->mean;
 	return std::move(utils::extract_column_vector(column, 0));
 }
 
-double pca::get_energy() const {
+template<typename T>
+T basic_pca<T>::get_energy() const {
 	return energy_(0);
 }
 
-std::vector<double> pca::get_energy_boot() const {
+template<typename T>
+T basic_pca<T>::get_noise_variance() const {
+	const long num_retained = std::min(num_retained_, long(eigval_.n_elem));
+	if (num_retained >= num_vars_)
+		return 0;
+	double retained = 0;
+	for (long i=0; i<num_retained; ++i)
+		retained += eigval_(i);
+	return std::max(0., energy_(0) * (1 - retained) / (num_vars_ - num_retained));
+}
+
+template<typename T>
+std::vector<T> basic_pca<T>::get_energy_boot() const {
 	return std::move(utils::extract_column_vector(energy_boot_, 0));
 }
 
-double pca::get_eigenvalue(long eigen_index) const {
-	if (eigen_index >= num_vars_)
+template<typename T>
+vector_view<T> basic_pca<T>::view_energy_boot() const {
+	return utils::view_column(energy_boot_, 0);
+}
+
+template<typename T>
+T basic_pca<T>::get_eigenvalue(long eigen_index) const {
+	if (eigen_index<0 || eigen_index>=long(eigval_.n_elem))
 		throw std::range_error(utils::join("Index out of range: ", eigen_index));
 	return eigval_(eigen_index);
 }
 
-std::vector<double> pca::get_eigenvalues() const {
+template<typename T>
+std::vector<T> basic_pca<T>::get_eigenvalues() const {
 	return std::move(utils::extract_column_vector(eigval_, 0));
 }
 
-std::vector<double> pca::get_eigenvalue_boot(long eigen_index) const {
+template<typename T>
+vector_view<T> basic_pca<T>::view_eigenvalues() const {
+	return utils::view_column(eigval_, 0);
+}
+
+template<typename T>
+std::vector<T> basic_pca<T>::get_eigenvalue_boot(long eigen_index) const {
 	return std::move(utils::extract_column_vector(eigval_boot_, eigen_index));
 }
 
-std::vector<double> pca::get_eigenvector(long eigen_index) const {
+template<typename T>
+vector_view<T> basic_pca<T>::view_eigenvalue_boot(long eigen_index) const {
+	return utils::view_column(eigval_boot_, eigen_index);
+}
+
+template<typename T>
+std::vector<T> basic_pca<T>::get_eigenvector(long eigen_index) const {
 	return std::move(utils::extract_column_vector(eigvec_, eigen_index));
 }
 
-std::vector<double> pca::get_principal(long eigen_index) const {
+template<typename T>
+vector_view<T> basic_pca<T>::view_eigenvector(long eigen_index) const {
+	return utils::view_column(eigvec_, eigen_index);
+}
+
+template<typename T>
+std::vector<T> basic_pca<T>::get_principal(long eigen_index) const {
 	return std::move(utils::extract_column_vector(princomp_, eigen_index));
 }
 
-double pca::check_eigenvectors_orthogonal() const {
+template<typename T>
+vector_view<T> basic_pca<T>::view_principal(long eigen_index) const {
+	return utils::view_column(princomp_, eigen_index);
+}
+
+template<typename T>
+double basic_pca<T>::check_eigenvectors_orthogonal() const {
+	if (eigvec_.n_rows!=eigvec_.n_cols)
+		return std::sqrt(std::abs(arma::det(eigvec_.t() * eigvec_)));
 	return std::abs(arma::det(eigvec_));
 }
 
-double pca::check_projection_accurate() const {
+template<typename T>
+double basic_pca<T>::check_projection_accurate() const {
 	if (data_.n_cols!=eigvec_.n_cols || data_.n_rows!=princomp_.n_rows)
 		throw std::runtime_error("No proper data matrix present that the projection could be compared with.");
-	const arma::Mat<double> diff = (princomp_ * arma::trans(eigvec_)) - data_;
-	return 1 - arma::sum(arma::sum( arma::abs(diff) )) / diff.n_elem;
+	// the records are standardized like in solve and missing values are left out
+	arma::Mat<T> records = data_;
+	utils::remove_column_means(records, mean_);
+	if (do_normalize_) utils::normalize_by_column(records, sigma_);
+	arma::Mat<T> diff = (princomp_ * arma::trans(eigvec_)) - records;
+	const std::vector<arma::uword> missing = get_missing_indices_();
+	for (arma::uword index : missing)
+		diff[index] = 0;
+	return 1 - arma::sum(arma::sum( arma::abs(diff) )) / (diff.n_elem - missing.size());
 }
 
-bool pca::get_do_normalize() const {
+template<typename T>
+bool basic_pca<T>::get_do_normalize() const {
 	return do_normalize_;
 }
 
-bool pca::get_do_bootstrap() const {
+template<typename T>
+bool basic_pca<T>::get_do_bootstrap() const {
 	return do_bootstrap_;
 }
 
-long pca::get_num_bootstraps() const {
+template<typename T>
+long basic_pca<T>::get_num_bootstraps() const {
 	return num_bootstraps_;
 }
 
-long pca::get_bootstrap_seed() const {
+template<typename T>
+long basic_pca<T>::get_bootstrap_seed() const {
 	return bootstrap_seed_;
 }
 
-std::string pca::get_solver() const {
+template<typename T>
+std::string basic_pca<T>::get_solver() const {
 	return solver_;
 }
 
-std::vector<double> pca::get_mean_values() const {
+template<typename T>
+std::string basic_pca<T>::get_chosen_solver() const {
+	return chosen_solver_;
+}
+
+template<typename T>
+std::vector<T> basic_pca<T>::get_mean_values() const {
 	return std::move(utils::extract_column_vector(mean_, 0));
 }
 
-std::vector<double> pca::get_sigma_values() const {
+template<typename T>
+std::vector<T> basic_pca<T>::get_sigma_values() const {
 	return std::move(utils::extract_column_vector(sigma_, 0));
 }
 
-long pca::get_num_variables() const {
+template<typename T>
+vector_view<T> basic_pca<T>::view_mean_values() const {
+	return utils::view_column(mean_, 0);
+}
+
+template<typename T>
+vector_view<T> basic_pca<T>::view_sigma_values() const {
+	return utils::view_column(sigma_, 0);
+}
+
+template<typename T>
+long basic_pca<T>::get_num_variables() const {
 	return num_vars_;
 }
 
-long pca::get_num_records() const {
+template<typename T>
+long basic_pca<T>::get_num_records() const {
 	return num_records_;
 }
 
-long pca::get_num_retained() const {
+template<typename T>
+long basic_pca<T>::get_num_retained() const {
 	return num_retained_;
 }
 
-void pca::save(const std::string& basename) const {
+template<typename T>
+void basic_pca<T>::save(const std::string& basename) const {
 	const std::string filename = basename + ".pca";
 	std::ofstream file(filename.c_str());
 	utils::assert_file_good(file.good(), filename);
@@ -337,7 +1128,8 @@ void pca::save(const std::string& basename) const {
 	}
 }
 
-void pca::load(const std::string& basename) {
+template<typename T>
+void basic_pca<T>::load(const std::string& basename) {
 	const std::string filename = basename + ".pca";
 	std::ifstream file(filename.c_str());
 	utils::assert_file_good(file.good(), filename);
@@ -365,4 +1157,24 @@ void pca::load(const std::string& basename) {
 	set_num_retained(num_retained_);
 }
 
+template<typename T>
+void solve_all(const std::vector<basic_pca<T>*>& models, const std::shared_ptr<thread_pool>& pool) {
+	const scoped_thread_pool scope(pool);
+	std::vector<double> costs(models.size());
+	for (size_t i=0; i<models.size(); ++i) {
+		const double num_vars = models[i]->get_num_variables();
+		const double num_records = models[i]->get_num_records();
+		const double num_solves = models[i]->get_do_bootstrap() ? 1 + models[i]->get_num_bootstraps() : 1;
+		costs[i] = num_solves * (num_records * num_vars * num_vars + num_vars * num_vars * num_vars);
+	}
+	thread_pool::get_current().parallel_for_largest_first(costs, [&models](long index) {
+		models[index]->solve();
+	});
+}
+
+template class basic_pca<float>;
+template class basic_pca<double>;
+template void solve_all(const std::vector<basic_pca<float>*>&, const std::shared_ptr<thread_pool>&);
+template void solve_all(const std::vector<basic_pca<double>*>&, const std::shared_ptr<thread_pool>&);
+
 } // stats
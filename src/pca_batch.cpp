@@ -0,0 +1,317 @@
+/**
+ * @file pca_batch.cpp
+ * @brief Principal component analysis of many small independent models
+ */
+#include "pca_batch.h"
+#include <stdexcept>
+#include <algorithm>
+
+namespace stats {
+
+const long batch_grain_elements = 65536;
+
+template<typename T>
+basic_pca_batch<T>::basic_pca_batch()
+	: solver_("dc"),
+	  do_normalize_(false)
+{}
+
+template<typename T>
+basic_pca_batch<T>::~basic_pca_batch()
+{}
+
+template<typename T>
+long basic_pca_batch<T>::add_model(long num_vars) {
+	if (num_vars < 2)
+		throw std::invalid_argument("Number of variables smaller than two.");
+	num_vars_.push_back(num_vars);
+	num_records_.push_back(0);
+	// mean and upper triangle of the co-moment matrix in packed storage
+	moment_offsets_.push_back(moments_.size());
+	moments_.resize(moments_.size() + num_vars + num_vars * (num_vars + 1) / 2, 0.);
+	// mean, sigma, eigenvalues and eigenvectors
+	result_offsets_.push_back(results_.size());
+	results_.resize(results_.size() + 3 * num_vars + num_vars * num_vars, T(0));
+	energy_.push_back(0);
+	return num_vars_.size() - 1;
+}
+
+template<typename T>
+long basic_pca_batch<T>::get_num_models() const {
+	return num_vars_.size();
+}
+
+template<typename T>
+long basic_pca_batch<T>::get_num_variables(long model) const {
+	assert_model_(model);
+	return num_vars_[model];
+}
+
+template<typename T>
+void basic_pca_batch<T>::assert_model_(long model) const {
+	if (model<0 || model>=long(num_vars_.size()))
+		throw std::range_error(utils::join("Index out of range: ", model));
+}
+
+template<typename T>
+void basic_pca_batch<T>::assert_size_(long model, long size) const {
+	if (num_vars_[model] != size)
+		throw std::domain_error(utils::join("Record has the wrong size: ", size));
+}
+
+template<typename T>
+void basic_pca_batch<T>::add_record(long model, const std::vector<T>& record) {
+	assert_model_(model);
+	assert_size_(model, record.size());
+	const long n = num_vars_[model];
+	double* mean = &moments_[moment_offsets_[model]];
+	double* comoment = mean + n;
+	const long count = ++num_records_[model];
+	// Welford's update of the upper triangle of the co-moment matrix where
+	// (x - mean_new) equals (x - mean_old) * (count - 1) / count
+	const double factor = double(count - 1) / count;
+	for (long j=0; j<n; ++j) {
+		const double delta = (record[j] - mean[j]) * factor;
+		double* column = comoment + j * (j + 1) / 2;
+		for (long i=0; i<=j; ++i)
+			column[i] += (record[i] - mean[i]) * delta;
+	}
+	for (long i=0; i<n; ++i)
+		mean[i] += (record[i] - mean[i]) / count;
+}
+
+template<typename T>
+long basic_pca_batch<T>::get_num_records(long model) const {
+	assert_model_(model);
+	return num_records_[model];
+}
+
+template<typename T>
+void basic_pca_batch<T>::set_do_normalize(bool do_normalize) {
+	do_normalize_ = do_normalize;
+}
+
+template<typename T>
+bool basic_pca_batch<T>::get_do_normalize() const {
+	return do_normalize_;
+}
+
+template<typename T>
+void basic_pca_batch<T>::set_solver(const std::string& solver) {
+	if (solver!="standard" && solver!="dc" && solver!="packed")
+		throw std::invalid_argument(utils::join("No such solver available: ", solver));
+	solver_ = solver;
+}
+
+template<typename T>
+std::string basic_pca_batch<T>::get_solver() const {
+	return solver_;
+}
+
+template<typename T>
+void basic_pca_batch<T>::set_num_threads(long num_threads) {
+	thread_pool_ = std::make_shared<thread_pool>(num_threads);
+}
+
+template<typename T>
+long basic_pca_batch<T>::get_num_threads() const {
+	return get_thread_pool()->get_num_threads();
+}
+
+template<typename T>
+void basic_pca_batch<T>::set_thread_pool(const std::shared_ptr<thread_pool>& pool) {
+	thread_pool_ = pool;
+}
+
+template<typename T>
+std::shared_ptr<thread_pool> basic_pca_batch<T>::get_thread_pool() const {
+	return thread_pool_ ? thread_pool_ : thread_pool::get_default();
+}
+
+template<typename T>
+void basic_pca_batch<T>::solve() {
+	const long num_models = num_vars_.size();
+	for (long model=0; model<num_models; ++model) {
+		if (num_records_[model] < 2)
+			throw std::logic_error(utils::join("Number of records smaller than two for model: ", model));
+	}
+
+	// models sorted by size are grouped into chunks sharing one workspace
+	// and the chunks are scheduled largest first
+	std::vector<long> order(num_models);
+	for (long model=0; model<num_models; ++model) order[model] = model;
+	std::stable_sort(order.begin(), order.end(), [this](long i, long j) { return num_vars_[i] > num_vars_[j]; });
+	std::vector<long> chunks;
+	std::vector<double> costs;
+	double chunk_elements = 0;
+	for (long k=0; k<num_models; ++k) {
+		const double n = num_vars_[order[k]];
+		if (chunks.empty() || chunk_elements + n * n > batch_grain_elements) {
+			chunks.push_back(k);
+			costs.push_back(0);
+			chunk_elements = 0;
+		}
+		chunk_elements += n * n;
+		costs.back() += n * n * n;
+	}
+	chunks.push_back(num_models);
+
+	const scoped_thread_pool scope(thread_pool_);
+	thread_pool& pool = thread_pool::get_current();
+	const utils::scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+
+	pool.parallel_for_largest_first(costs, [this, &order, &chunks](long chunk) {
+		const long max_vars = num_vars_[order[chunks[chunk]]];
+		std::vector<double> workspace(2 * max_vars * max_vars + max_vars);
+		for (long k=chunks[chunk]; k<chunks[chunk + 1]; ++k)
+			solve_model_(order[k], workspace);
+	});
+}
+
+template<typename T>
+void basic_pca_batch<T>::solve_model_(long model, std::vector<double>& workspace) {
+	const long n = num_vars_[model];
+	const double* mean = &moments_[moment_offsets_[model]];
+	const double* comoment = mean + n;
+	const double scale = 1. / (num_records_[model] - 1);
+
+	arma::Mat<double> eigvec(&workspace[n * n], n, n, false, true);
+	arma::Col<double> eigval(&workspace[2 * n * n], n, false, true);
+
+	T* result = &results_[result_offsets_[model]];
+	T* sigma = result + n;
+	for (long i=0; i<n; ++i) {
+		result[i] = mean[i];
+		sigma[i] = std::sqrt(comoment[i + i * (i + 1) / 2] * scale);
+	}
+	if (do_normalize_) {
+		for (long i=0; i<n; ++i) {
+			if (sigma[i]==0)
+				throw std::runtime_error(utils::join("At least one of the variables has zero variance in model: ", model));
+		}
+	}
+
+	if (solver_=="packed") {
+		arma::Col<double> packed(&workspace[0], n * (n + 1) / 2, false, true);
+		for (long j=0; j<n; ++j) {
+			for (long i=0; i<=j; ++i) {
+				const long index = i + j * (j + 1) / 2;
+				packed[index] = comoment[index] * scale;
+				if (do_normalize_) packed[index] /= double(sigma[i]) * sigma[j];
+			}
+		}
+		utils::eig_sym_packed(eigval, eigvec, packed, n);
+	} else {
+		arma::Mat<double> cov_mat(&workspace[0], n, n, false, true);
+		for (long j=0; j<n; ++j) {
+			for (long i=0; i<=j; ++i) {
+				cov_mat.at(i, j) = comoment[i + j * (j + 1) / 2] * scale;
+				if (do_normalize_) cov_mat.at(i, j) /= double(sigma[i]) * sigma[j];
+				cov_mat.at(j, i) = cov_mat.at(i, j);
+			}
+		}
+		arma::eig_sym(eigval, eigvec, cov_mat, solver_.c_str());
+	}
+
+	T* result_eigval = sigma + n;
+	arma::Mat<T> result_eigvec(result_eigval + n, n, n, false, true);
+	double energy = 0;
+	for (long i=0; i<n; ++i) {
+		const long source = n - 1 - i;
+		result_eigval[i] = eigval(source);
+		energy += eigval(source);
+		for (long k=0; k<n; ++k)
+			result_eigvec.at(k, i) = eigvec.at(k, source);
+	}
+	utils::enforce_positive_sign_by_column(result_eigvec);
+	energy_[model] = energy;
+	for (long i=0; i<n; ++i)
+		result_eigval[i] /= energy;
+}
+
+template<typename T>
+const T* basic_pca_batch<T>::get_results_(long model) const {
+	assert_model_(model);
+	return &results_[result_offsets_[model]];
+}
+
+template<typename T>
+T basic_pca_batch<T>::get_energy(long model) const {
+	assert_model_(model);
+	return energy_[model];
+}
+
+template<typename T>
+std::vector<T> basic_pca_batch<T>::get_eigenvalues(long model) const {
+	const T* eigval = get_results_(model) + 2 * num_vars_[model];
+	return std::vector<T>(eigval, eigval + num_vars_[model]);
+}
+
+template<typename T>
+std::vector<T> basic_pca_batch<T>::get_eigenvector(long model, long eigen_index) const {
+	const T* results = get_results_(model);
+	const long n = num_vars_[model];
+	if (eigen_index<0 || eigen_index>=n)
+		throw std::range_error(utils::join("Index out of range: ", eigen_index));
+	const T* eigvec = results + 3 * n + eigen_index * n;
+	return std::vector<T>(eigvec, eigvec + n);
+}
+
+template<typename T>
+std::vector<T> basic_pca_batch<T>::get_mean_values(long model) const {
+	const T* mean = get_results_(model);
+	return std::vector<T>(mean, mean + num_vars_[model]);
+}
+
+template<typename T>
+std::vector<T> basic_pca_batch<T>::get_sigma_values(long model) const {
+	const T* sigma = get_results_(model) + num_vars_[model];
+	return std::vector<T>(sigma, sigma + num_vars_[model]);
+}
+
+template<typename T>
+std::vector<T> basic_pca_batch<T>::to_principal_space(long model, const std::vector<T>& record) const {
+	const T* results = get_results_(model);
+	assert_size_(model, record.size());
+	const long n = num_vars_[model];
+	const T* mean = results;
+	const T* sigma = results + n;
+	const T* eigvec = results + 3 * n;
+	std::vector<double> centered(n);
+	for (long j=0; j<n; ++j) {
+		centered[j] = record[j] - mean[j];
+		if (do_normalize_) centered[j] /= sigma[j];
+	}
+	std::vector<T> result(n);
+	for (long i=0; i<n; ++i) {
+		double value = 0;
+		for (long j=0; j<n; ++j)
+			value += eigvec[i * n + j] * centered[j];
+		result[i] = value;
+	}
+	return std::move(result);
+}
+
+template<typename T>
+std::vector<T> basic_pca_batch<T>::to_variable_space(long model, const std::vector<T>& data) const {
+	const T* results = get_results_(model);
+	assert_size_(model, data.size());
+	const long n = num_vars_[model];
+	const T* mean = results;
+	const T* sigma = results + n;
+	const T* eigvec = results + 3 * n;
+	std::vector<T> result(n);
+	for (long j=0; j<n; ++j) {
+		double value = 0;
+		for (long i=0; i<n; ++i)
+			value += eigvec[i * n + j] * data[i];
+		if (do_normalize_) value *= sigma[j];
+		result[j] = value + mean[j];
+	}
+	return std::move(result);
+}
+
+template class basic_pca_batch<float>;
+template class basic_pca_batch<double>;
+
+} //stats
@@ -0,0 +1,108 @@
+/**
+ * @file record_buffer.cpp
+ * @brief A record buffer for concurrent producers
+ */
+#include "record_buffer.h"
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+namespace stats {
+
+namespace {
+
+std::atomic<long> next_thread_slot(0);
+
+long get_thread_slot() {
+	thread_local const long slot = next_thread_slot++;
+	return slot;
+}
+
+} //anonymous
+
+template<typename T>
+sharded_record_buffer<T>::sharded_record_buffer(long num_shards)
+	: num_shards_(num_shards>0 ? num_shards : std::max(8L, 2 * long(std::thread::hardware_concurrency()))),
+	  shards_(new shard[num_shards_])
+{}
+
+template<typename T>
+sharded_record_buffer<T>::sharded_record_buffer(const sharded_record_buffer& other)
+	: num_shards_(other.num_shards_),
+	  shards_(new shard[num_shards_])
+{
+	for (long i=0; i<num_shards_; ++i) {
+		std::lock_guard<std::mutex> lock(other.shards_[i].mutex);
+		shards_[i].values = other.shards_[i].values;
+		shards_[i].weights = other.shards_[i].weights;
+	}
+}
+
+template<typename T>
+sharded_record_buffer<T>& sharded_record_buffer<T>::operator=(const sharded_record_buffer& other) {
+	if (this!=&other) {
+		sharded_record_buffer copy(other);
+		num_shards_ = copy.num_shards_;
+		shards_ = std::move(copy.shards_);
+	}
+	return *this;
+}
+
+template<typename T>
+long sharded_record_buffer<T>::get_num_shards() const {
+	return num_shards_;
+}
+
+template<typename T>
+typename sharded_record_buffer<T>::shard& sharded_record_buffer<T>::get_shard_() {
+	return shards_[get_thread_slot() % num_shards_];
+}
+
+template<typename T>
+void sharded_record_buffer<T>::append(const T* record, long num_vars) {
+	append(record, num_vars, 1.);
+}
+
+template<typename T>
+void sharded_record_buffer<T>::append(const T* record, long num_vars, double weight) {
+	shard& target = get_shard_();
+	std::lock_guard<std::mutex> lock(target.mutex);
+	target.values.insert(target.values.end(), record, record + num_vars);
+	target.weights.push_back(weight);
+}
+
+template<typename T>
+long sharded_record_buffer<T>::size() const {
+	long result = 0;
+	for (long i=0; i<num_shards_; ++i) {
+		std::lock_guard<std::mutex> lock(shards_[i].mutex);
+		result += shards_[i].values.size();
+	}
+	return result;
+}
+
+template<typename T>
+std::vector<typename sharded_record_buffer<T>::chunk> sharded_record_buffer<T>::take() {
+	std::vector<chunk> result;
+	for (long i=0; i<num_shards_; ++i) {
+		chunk taken;
+		{
+			std::lock_guard<std::mutex> lock(shards_[i].mutex);
+			taken.values.swap(shards_[i].values);
+			taken.weights.swap(shards_[i].weights);
+		}
+		if (!taken.weights.empty())
+			result.push_back(std::move(taken));
+	}
+	return std::move(result);
+}
+
+template<typename T>
+void sharded_record_buffer<T>::clear() {
+	take();
+}
+
+template class sharded_record_buffer<float>;
+template class sharded_record_buffer<double>;
+
+} //stats
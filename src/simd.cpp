@@ -0,0 +1,393 @@
+/**
+ * @file simd.cpp
+ * @brief Vectorized kernels selected at runtime via CPU feature detection
+ */
+#include "pca.h"
+#include "simd.h"
+#include <stdexcept>
+#include <atomic>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define PCA_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace stats {
+namespace utils {
+namespace simd {
+
+enum instruction_set { generic, avx2, avx512, num_instruction_sets };
+
+const char* const instruction_set_names[num_instruction_sets] = {"generic", "avx2", "avx512"};
+
+template<typename T>
+double sum_generic(const T* x, long n) {
+	double sum = 0;
+	for (long i=0; i<n; ++i)
+		sum += x[i];
+	return sum;
+}
+
+template<typename T>
+double sum_squares_generic(const T* x, long n) {
+	double sum = 0;
+	for (long i=0; i<n; ++i)
+		sum += double(x[i]) * x[i];
+	return sum;
+}
+
+template<typename T>
+double dot_generic(const T* x, const T* y, long n) {
+	double sum = 0;
+	for (long i=0; i<n; ++i)
+		sum += double(x[i]) * y[i];
+	return sum;
+}
+
+template<typename T>
+void subtract_generic(T* x, long n, T value) {
+	for (long i=0; i<n; ++i)
+		x[i] -= value;
+}
+
+template<typename T>
+void scale_generic(T* x, long n, T factor) {
+	for (long i=0; i<n; ++i)
+		x[i] *= factor;
+}
+
+#ifdef PCA_X86_DISPATCH
+
+#define PCA_AVX2 __attribute__((target("avx2,fma")))
+#define PCA_AVX512 __attribute__((target("avx512f")))
+
+PCA_AVX2 inline double reduce_avx2(__m256d v) {
+	const __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+	return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+}
+
+PCA_AVX2 double sum_avx2(const double* x, long n) {
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i+8<=n; i+=8) {
+		acc0 = _mm256_add_pd(acc0, _mm256_loadu_pd(x+i));
+		acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(x+i+4));
+	}
+	double sum = reduce_avx2(_mm256_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i];
+	return sum;
+}
+
+PCA_AVX2 double sum_avx2(const float* x, long n) {
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i+8<=n; i+=8) {
+		acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm_loadu_ps(x+i)));
+		acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm_loadu_ps(x+i+4)));
+	}
+	double sum = reduce_avx2(_mm256_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i];
+	return sum;
+}
+
+PCA_AVX2 double sum_squares_avx2(const double* x, long n) {
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i+8<=n; i+=8) {
+		const __m256d x0 = _mm256_loadu_pd(x+i);
+		const __m256d x1 = _mm256_loadu_pd(x+i+4);
+		acc0 = _mm256_fmadd_pd(x0, x0, acc0);
+		acc1 = _mm256_fmadd_pd(x1, x1, acc1);
+	}
+	double sum = reduce_avx2(_mm256_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i] * x[i];
+	return sum;
+}
+
+PCA_AVX2 double sum_squares_avx2(const float* x, long n) {
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i+8<=n; i+=8) {
+		const __m256d x0 = _mm256_cvtps_pd(_mm_loadu_ps(x+i));
+		const __m256d x1 = _mm256_cvtps_pd(_mm_loadu_ps(x+i+4));
+		acc0 = _mm256_fmadd_pd(x0, x0, acc0);
+		acc1 = _mm256_fmadd_pd(x1, x1, acc1);
+	}
+	double sum = reduce_avx2(_mm256_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += double(x[i]) * x[i];
+	return sum;
+}
+
+PCA_AVX2 double dot_avx2(const double* x, const double* y, long n) {
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i+8<=n; i+=8) {
+		acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x+i), _mm256_loadu_pd(y+i), acc0);
+		acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x+i+4), _mm256_loadu_pd(y+i+4), acc1);
+	}
+	double sum = reduce_avx2(_mm256_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i] * y[i];
+	return sum;
+}
+
+PCA_AVX2 double dot_avx2(const float* x, const float* y, long n) {
+	__m256d acc0 = _mm256_setzero_pd();
+	__m256d acc1 = _mm256_setzero_pd();
+	long i = 0;
+	for (; i+8<=n; i+=8) {
+		acc0 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(x+i)), _mm256_cvtps_pd(_mm_loadu_ps(y+i)), acc0);
+		acc1 = _mm256_fmadd_pd(_mm256_cvtps_pd(_mm_loadu_ps(x+i+4)), _mm256_cvtps_pd(_mm_loadu_ps(y+i+4)), acc1);
+	}
+	double sum = reduce_avx2(_mm256_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += double(x[i]) * y[i];
+	return sum;
+}
+
+PCA_AVX2 void subtract_avx2(double* x, long n, double value) {
+	const __m256d v = _mm256_set1_pd(value);
+	long i = 0;
+	for (; i+4<=n; i+=4)
+		_mm256_storeu_pd(x+i, _mm256_sub_pd(_mm256_loadu_pd(x+i), v));
+	for (; i<n; ++i)
+		x[i] -= value;
+}
+
+PCA_AVX2 void subtract_avx2(float* x, long n, float value) {
+	const __m256 v = _mm256_set1_ps(value);
+	long i = 0;
+	for (; i+8<=n; i+=8)
+		_mm256_storeu_ps(x+i, _mm256_sub_ps(_mm256_loadu_ps(x+i), v));
+	for (; i<n; ++i)
+		x[i] -= value;
+}
+
+PCA_AVX2 void scale_avx2(double* x, long n, double factor) {
+	const __m256d v = _mm256_set1_pd(factor);
+	long i = 0;
+	for (; i+4<=n; i+=4)
+		_mm256_storeu_pd(x+i, _mm256_mul_pd(_mm256_loadu_pd(x+i), v));
+	for (; i<n; ++i)
+		x[i] *= factor;
+}
+
+PCA_AVX2 void scale_avx2(float* x, long n, float factor) {
+	const __m256 v = _mm256_set1_ps(factor);
+	long i = 0;
+	for (; i+8<=n; i+=8)
+		_mm256_storeu_ps(x+i, _mm256_mul_ps(_mm256_loadu_ps(x+i), v));
+	for (; i<n; ++i)
+		x[i] *= factor;
+}
+
+// GCC reports the undefined vectors used internally by some AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+PCA_AVX512 double sum_avx512(const double* x, long n) {
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i+16<=n; i+=16) {
+		acc0 = _mm512_add_pd(acc0, _mm512_loadu_pd(x+i));
+		acc1 = _mm512_add_pd(acc1, _mm512_loadu_pd(x+i+8));
+	}
+	double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i];
+	return sum;
+}
+
+PCA_AVX512 double sum_avx512(const float* x, long n) {
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i+16<=n; i+=16) {
+		acc0 = _mm512_add_pd(acc0, _mm512_cvtps_pd(_mm256_loadu_ps(x+i)));
+		acc1 = _mm512_add_pd(acc1, _mm512_cvtps_pd(_mm256_loadu_ps(x+i+8)));
+	}
+	double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i];
+	return sum;
+}
+
+PCA_AVX512 double sum_squares_avx512(const double* x, long n) {
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i+16<=n; i+=16) {
+		const __m512d x0 = _mm512_loadu_pd(x+i);
+		const __m512d x1 = _mm512_loadu_pd(x+i+8);
+		acc0 = _mm512_fmadd_pd(x0, x0, acc0);
+		acc1 = _mm512_fmadd_pd(x1, x1, acc1);
+	}
+	double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i] * x[i];
+	return sum;
+}
+
+PCA_AVX512 double sum_squares_avx512(const float* x, long n) {
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i+16<=n; i+=16) {
+		const __m512d x0 = _mm512_cvtps_pd(_mm256_loadu_ps(x+i));
+		const __m512d x1 = _mm512_cvtps_pd(_mm256_loadu_ps(x+i+8));
+		acc0 = _mm512_fmadd_pd(x0, x0, acc0);
+		acc1 = _mm512_fmadd_pd(x1, x1, acc1);
+	}
+	double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += double(x[i]) * x[i];
+	return sum;
+}
+
+PCA_AVX512 double dot_avx512(const double* x, const double* y, long n) {
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i+16<=n; i+=16) {
+		acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x+i), _mm512_loadu_pd(y+i), acc0);
+		acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x+i+8), _mm512_loadu_pd(y+i+8), acc1);
+	}
+	double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += x[i] * y[i];
+	return sum;
+}
+
+PCA_AVX512 double dot_avx512(const float* x, const float* y, long n) {
+	__m512d acc0 = _mm512_setzero_pd();
+	__m512d acc1 = _mm512_setzero_pd();
+	long i = 0;
+	for (; i+16<=n; i+=16) {
+		acc0 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x+i)), _mm512_cvtps_pd(_mm256_loadu_ps(y+i)), acc0);
+		acc1 = _mm512_fmadd_pd(_mm512_cvtps_pd(_mm256_loadu_ps(x+i+8)), _mm512_cvtps_pd(_mm256_loadu_ps(y+i+8)), acc1);
+	}
+	double sum = _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+	for (; i<n; ++i)
+		sum += double(x[i]) * y[i];
+	return sum;
+}
+
+PCA_AVX512 void subtract_avx512(double* x, long n, double value) {
+	const __m512d v = _mm512_set1_pd(value);
+	long i = 0;
+	for (; i+8<=n; i+=8)
+		_mm512_storeu_pd(x+i, _mm512_sub_pd(_mm512_loadu_pd(x+i), v));
+	for (; i<n; ++i)
+		x[i] -= value;
+}
+
+PCA_AVX512 void subtract_avx512(float* x, long n, float value) {
+	const __m512 v = _mm512_set1_ps(value);
+	long i = 0;
+	for (; i+16<=n; i+=16)
+		_mm512_storeu_ps(x+i, _mm512_sub_ps(_mm512_loadu_ps(x+i), v));
+	for (; i<n; ++i)
+		x[i] -= value;
+}
+
+PCA_AVX512 void scale_avx512(double* x, long n, double factor) {
+	const __m512d v = _mm512_set1_pd(factor);
+	long i = 0;
+	for (; i+8<=n; i+=8)
+		_mm512_storeu_pd(x+i, _mm512_mul_pd(_mm512_loadu_pd(x+i), v));
+	for (; i<n; ++i)
+		x[i] *= factor;
+}
+
+PCA_AVX512 void scale_avx512(float* x, long n, float factor) {
+	const __m512 v = _mm512_set1_ps(factor);
+	long i = 0;
+	for (; i+16<=n; i+=16)
+		_mm512_storeu_ps(x+i, _mm512_mul_ps(_mm512_loadu_ps(x+i), v));
+	for (; i<n; ++i)
+		x[i] *= factor;
+}
+
+#pragma GCC diagnostic pop
+
+#endif
+
+bool is_supported(instruction_set isa) {
+#ifdef PCA_X86_DISPATCH
+	__builtin_cpu_init();
+	switch (isa) {
+	case avx512: return __builtin_cpu_supports("avx512f");
+	case avx2: return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	default: return isa==generic;
+	}
+#else
+	return isa==generic;
+#endif
+}
+
+instruction_set detect_instruction_set() {
+	if (is_supported(avx512)) return avx512;
+	if (is_supported(avx2)) return avx2;
+	return generic;
+}
+
+std::atomic<int>& active_instruction_set() {
+	static std::atomic<int> isa(detect_instruction_set());
+	return isa;
+}
+
+template<typename T>
+const kernels<T>* make_kernel_table() {
+	static const kernels<T> table[num_instruction_sets] = {
+		{sum_generic<T>, sum_squares_generic<T>, dot_generic<T>, subtract_generic<T>, scale_generic<T>},
+#ifdef PCA_X86_DISPATCH
+		{sum_avx2, sum_squares_avx2, dot_avx2, subtract_avx2, scale_avx2},
+		{sum_avx512, sum_squares_avx512, dot_avx512, subtract_avx512, scale_avx512},
+#else
+		{sum_generic<T>, sum_squares_generic<T>, dot_generic<T>, subtract_generic<T>, scale_generic<T>},
+		{sum_generic<T>, sum_squares_generic<T>, dot_generic<T>, subtract_generic<T>, scale_generic<T>},
+#endif
+	};
+	return table;
+}
+
+template<typename T>
+const kernels<T>& get_kernels() {
+	static const kernels<T>* table = make_kernel_table<T>();
+	return table[active_instruction_set().load(std::memory_order_relaxed)];
+}
+
+template const kernels<float>& get_kernels();
+template const kernels<double>& get_kernels();
+
+} //simd
+
+std::string get_instruction_set() {
+	return simd::instruction_set_names[simd::active_instruction_set().load()];
+}
+
+void set_instruction_set(const std::string& instruction_set) {
+	for (int isa=0; isa<simd::num_instruction_sets; ++isa) {
+		if (instruction_set==simd::instruction_set_names[isa]) {
+			if (!simd::is_supported(simd::instruction_set(isa)))
+				throw std::invalid_argument(join("Instruction set not supported by this CPU: ", instruction_set));
+			simd::active_instruction_set().store(isa);
+			return;
+		}
+	}
+	throw std::invalid_argument(join("No such instruction set available: ", instruction_set));
+}
+
+} //utils
+} //stats
@@ -0,0 +1,46 @@
+#pragma once
+/**
+ * @file simd.h
+ * @brief Vectorized kernels selected at runtime via CPU feature detection
+ */
+
+namespace stats {
+namespace utils {
+namespace simd {
+/**
+ * @brief A table of kernels operating on contiguous memory. All reductions
+ * 	are accumulated in double precision
+ */
+template<typename T>
+struct kernels {
+	/**
+	 * @brief Computes the sum of n values
+	 */
+	double (*sum)(const T* x, long n);
+	/**
+	 * @brief Computes the sum of squares of n values
+	 */
+	double (*sum_squares)(const T* x, long n);
+	/**
+	 * @brief Computes the dot product of n values
+	 */
+	double (*dot)(const T* x, const T* y, long n);
+	/**
+	 * @brief Subtracts value from n values
+	 */
+	void (*subtract)(T* x, long n, T value);
+	/**
+	 * @brief Multiplies n values by factor
+	 */
+	void (*scale)(T* x, long n, T factor);
+};
+/**
+ * @brief Returns the kernels of the currently selected instruction set
+ * @return The kernels
+ */
+template<typename T>
+const kernels<T>& get_kernels();
+
+} //simd
+} //utils
+} //stats
@@ -0,0 +1,357 @@
+/**
+ * @file sparse_pca.cpp
+ * @brief Principal component analysis of sparse records
+ */
+#include "sparse_pca.h"
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+namespace stats {
+
+const long sparse_block_records = 256;
+const long sparse_block_variables = 1024;
+
+template<typename T>
+basic_sparse_pca<T>::basic_sparse_pca(long num_vars)
+	: num_vars_(num_vars),
+	  num_components_(10),
+	  num_iterations_(4),
+	  oversampling_(10),
+	  seed_(1),
+	  do_normalize_(false),
+	  energy_(0),
+	  col_ptrs_(1, 0)
+{
+	if (num_vars_ < 2)
+		throw std::invalid_argument("Number of variables smaller than two.");
+}
+
+template<typename T>
+basic_sparse_pca<T>::~basic_sparse_pca()
+{}
+
+template<typename T>
+long basic_sparse_pca<T>::get_num_variables() const {
+	return num_vars_;
+}
+
+template<typename T>
+void basic_sparse_pca<T>::assert_indices_(const std::vector<long>& indices, const std::vector<T>& values) const {
+	if (indices.size()!=values.size())
+		throw std::domain_error(utils::join("Indices and values have different sizes: ", indices.size(), " and ", values.size()));
+	for (long index : indices) {
+		if (index<0 || index>=num_vars_)
+			throw std::range_error(utils::join("Index out of range: ", index));
+	}
+}
+
+template<typename T>
+void basic_sparse_pca<T>::add_record(const std::vector<long>& indices, const std::vector<T>& values) {
+	assert_indices_(indices, values);
+	std::vector<long> order(indices.size());
+	for (long k=0; k<long(order.size()); ++k) order[k] = k;
+	std::sort(order.begin(), order.end(), [&indices](long i, long j) { return indices[i] < indices[j]; });
+	for (long k=1; k<long(order.size()); ++k) {
+		if (indices[order[k]]==indices[order[k - 1]])
+			throw std::invalid_argument(utils::join("Duplicate index: ", indices[order[k]]));
+	}
+	for (long k : order) {
+		if (values[k]==T(0)) continue;
+		row_indices_.push_back(indices[k]);
+		values_.push_back(values[k]);
+	}
+	col_ptrs_.push_back(values_.size());
+}
+
+template<typename T>
+void basic_sparse_pca<T>::add_record(const std::vector<T>& record) {
+	if (num_vars_ != long(record.size()))
+		throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+	for (long j=0; j<num_vars_; ++j) {
+		if (record[j]==T(0)) continue;
+		row_indices_.push_back(j);
+		values_.push_back(record[j]);
+	}
+	col_ptrs_.push_back(values_.size());
+}
+
+template<typename T>
+long basic_sparse_pca<T>::get_num_records() const {
+	return col_ptrs_.size() - 1;
+}
+
+template<typename T>
+long basic_sparse_pca<T>::get_num_nonzeros() const {
+	return values_.size();
+}
+
+template<typename T>
+void basic_sparse_pca<T>::set_do_normalize(bool do_normalize) {
+	do_normalize_ = do_normalize;
+}
+
+template<typename T>
+bool basic_sparse_pca<T>::get_do_normalize() const {
+	return do_normalize_;
+}
+
+template<typename T>
+void basic_sparse_pca<T>::set_num_components(long num_components) {
+	if (num_components < 1)
+		throw std::range_error(utils::join("Value out of range: ", num_components));
+	num_components_ = num_components;
+}
+
+template<typename T>
+long basic_sparse_pca<T>::get_num_components() const {
+	return num_components_;
+}
+
+template<typename T>
+void basic_sparse_pca<T>::set_num_iterations(long num_iterations, long seed) {
+	if (num_iterations < 0)
+		throw std::invalid_argument("Number of iterations is negative.");
+	num_iterations_ = num_iterations;
+	seed_ = seed;
+}
+
+template<typename T>
+long basic_sparse_pca<T>::get_num_iterations() const {
+	return num_iterations_;
+}
+
+template<typename T>
+void basic_sparse_pca<T>::set_oversampling(long oversampling) {
+	if (oversampling < 0)
+		throw std::invalid_argument("Oversampling is negative.");
+	oversampling_ = oversampling;
+}
+
+template<typename T>
+long basic_sparse_pca<T>::get_oversampling() const {
+	return oversampling_;
+}
+
+template<typename T>
+void basic_sparse_pca<T>::set_num_threads(long num_threads) {
+	thread_pool_ = std::make_shared<thread_pool>(num_threads);
+}
+
+template<typename T>
+void basic_sparse_pca<T>::set_thread_pool(const std::shared_ptr<thread_pool>& pool) {
+	thread_pool_ = pool;
+}
+
+template<typename T>
+std::shared_ptr<thread_pool> basic_sparse_pca<T>::get_thread_pool() const {
+	return thread_pool_ ? thread_pool_ : thread_pool::get_default();
+}
+
+template<typename T>
+arma::Mat<double> basic_sparse_pca<T>::multiply_(const arma::SpMat<T>& records, const arma::Mat<double>& mat) const {
+	// (X - 1 mean^T) D^-1 M = X (D^-1 M) - 1 (mean^T D^-1 M)
+	arma::Mat<double> scaled = mat;
+	if (do_normalize_) {
+		for (long j=0; j<num_vars_; ++j)
+			scaled.row(j) /= sigma_(j);
+	}
+	const long num_cols = mat.n_cols;
+	const arma::Mat<double> offset = mean_.t() * scaled;
+	const long num_records = records.n_cols;
+	arma::Mat<double> result(num_records, num_cols);
+	thread_pool::get_current().parallel_for(0, num_records, sparse_block_records, [&](long first, long last) {
+		for (long i=first; i<last; ++i) {
+			for (long c=0; c<num_cols; ++c) {
+				double value = -offset(0, c);
+				for (arma::uword k=records.col_ptrs[i]; k<records.col_ptrs[i + 1]; ++k)
+					value += records.values[k] * scaled(records.row_indices[k], c);
+				result(i, c) = value;
+			}
+		}
+	});
+	return std::move(result);
+}
+
+template<typename T>
+arma::Mat<double> basic_sparse_pca<T>::multiply_transposed_(const arma::SpMat<T>& variables, const arma::Mat<double>& mat) const {
+	// D^-1 (X - 1 mean^T)^T M = D^-1 (X^T M - mean 1^T M)
+	const long num_cols = mat.n_cols;
+	std::vector<double> column_sums(num_cols, 0.);
+	for (long c=0; c<num_cols; ++c)
+		for (long i=0; i<long(mat.n_rows); ++i)
+			column_sums[c] += mat(i, c);
+	arma::Mat<double> result(num_vars_, num_cols);
+	thread_pool::get_current().parallel_for(0, num_vars_, sparse_block_variables, [&](long first, long last) {
+		for (long j=first; j<last; ++j) {
+			for (long c=0; c<num_cols; ++c) {
+				double value = -mean_(j) * column_sums[c];
+				for (arma::uword k=variables.col_ptrs[j]; k<variables.col_ptrs[j + 1]; ++k)
+					value += variables.values[k] * mat(variables.row_indices[k], c);
+				result(j, c) = do_normalize_ ? value / sigma_(j) : value;
+			}
+		}
+	});
+	return std::move(result);
+}
+
+template<typename T>
+void basic_sparse_pca<T>::solve() {
+	const long num_records = get_num_records();
+	if (num_records < 2)
+		throw std::logic_error("Number of records smaller than two.");
+
+	const scoped_thread_pool scope(thread_pool_);
+	thread_pool& pool = thread_pool::get_current();
+	const utils::scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+
+	// one column per record and its transpose with one column per variable
+	const arma::uvec row_indices(row_indices_);
+	const arma::uvec col_ptrs(col_ptrs_);
+	const arma::Col<T> values(values_);
+	const arma::SpMat<T> records(row_indices, col_ptrs, values, num_vars_, num_records);
+	const arma::SpMat<T> variables = records.t();
+
+	// moments from the non-zeros; each variable has (n - nnz) implicit zeros
+	mean_.set_size(num_vars_);
+	sigma_.set_size(num_vars_);
+	pool.parallel_for(0, num_vars_, sparse_block_variables, [&](long first, long last) {
+		for (long j=first; j<last; ++j) {
+			const arma::uword begin = variables.col_ptrs[j];
+			const arma::uword end = variables.col_ptrs[j + 1];
+			double sum = 0;
+			for (arma::uword k=begin; k<end; ++k)
+				sum += variables.values[k];
+			const double mean = sum / num_records;
+			double sum_sq = double(num_records - long(end - begin)) * mean * mean;
+			for (arma::uword k=begin; k<end; ++k)
+				sum_sq += (variables.values[k] - mean) * (variables.values[k] - mean);
+			mean_(j) = mean;
+			sigma_(j) = std::sqrt(sum_sq / (num_records - 1));
+		}
+	});
+	energy_ = 0;
+	for (long j=0; j<num_vars_; ++j) {
+		if (do_normalize_) {
+			if (sigma_(j)==0)
+				throw std::runtime_error("At least one of the variables has zero variance.");
+			energy_ += 1;
+		} else {
+			energy_ += sigma_(j) * sigma_(j);
+		}
+	}
+
+	// randomized subspace iteration on A^T A with A the implicitly centered data
+	const long num_components = std::min(num_components_, std::min(num_vars_, num_records));
+	const long subspace = std::min(num_components + oversampling_, num_vars_);
+	std::mt19937 generator(seed_);
+	std::normal_distribution<double> distribution;
+	arma::Mat<double> basis(num_vars_, subspace);
+	for (long k=0; k<long(basis.n_elem); ++k)
+		basis[k] = distribution(generator);
+	arma::Mat<double> ortho;
+	arma::Mat<double> upper;
+	for (long iter=0; iter<num_iterations_; ++iter) {
+		arma::qr_econ(ortho, upper, basis);
+		basis = multiply_transposed_(variables, multiply_(records, ortho));
+	}
+	arma::qr_econ(ortho, upper, basis);
+	basis = std::move(ortho);
+
+	// Rayleigh-Ritz projection onto the subspace
+	const arma::Mat<double> projected = multiply_(records, basis);
+	const arma::Mat<double> gram = projected.t() * projected * (1. / (num_records - 1));
+	arma::Col<double> eigval;
+	arma::Mat<double> eigvec;
+	arma::eig_sym(eigval, eigvec, gram);
+	arma::Mat<double> ritz(subspace, num_components);
+	eigval_.set_size(num_components);
+	for (long k=0; k<num_components; ++k) {
+		const long source = subspace - 1 - k;
+		eigval_(k) = std::max(0., eigval(source)) / energy_;
+		ritz.col(k) = eigvec.col(source);
+	}
+	eigvec_ = basis * ritz;
+	utils::enforce_positive_sign_by_column(eigvec_);
+
+	arma::Col<double> scaled_mean = mean_;
+	if (do_normalize_) scaled_mean /= sigma_;
+	projection_offset_ = scaled_mean.t() * eigvec_;
+}
+
+template<typename T>
+void basic_sparse_pca<T>::assert_solved_() const {
+	if (eigvec_.n_elem==0)
+		throw std::logic_error("Sparse PCA has not been solved.");
+}
+
+template<typename T>
+T basic_sparse_pca<T>::get_energy() const {
+	return energy_;
+}
+
+template<typename T>
+T basic_sparse_pca<T>::get_eigenvalue(long eigen_index) const {
+	if (eigen_index<0 || eigen_index>=long(eigval_.n_elem))
+		throw std::range_error(utils::join("Index out of range: ", eigen_index));
+	return eigval_(eigen_index);
+}
+
+template<typename T>
+std::vector<T> basic_sparse_pca<T>::get_eigenvalues() const {
+	return std::vector<T>(eigval_.memptr(), eigval_.memptr() + eigval_.n_elem);
+}
+
+template<typename T>
+std::vector<T> basic_sparse_pca<T>::get_eigenvector(long eigen_index) const {
+	if (eigen_index<0 || eigen_index>=long(eigvec_.n_cols))
+		throw std::range_error(utils::join("Index out of range: ", eigen_index));
+	const double* column = eigvec_.colptr(eigen_index);
+	return std::vector<T>(column, column + num_vars_);
+}
+
+template<typename T>
+std::vector<T> basic_sparse_pca<T>::get_mean_values() const {
+	return std::vector<T>(mean_.memptr(), mean_.memptr() + mean_.n_elem);
+}
+
+template<typename T>
+std::vector<T> basic_sparse_pca<T>::get_sigma_values() const {
+	return std::vector<T>(sigma_.memptr(), sigma_.memptr() + sigma_.n_elem);
+}
+
+template<typename T>
+std::vector<T> basic_sparse_pca<T>::to_principal_space(const std::vector<long>& indices, const std::vector<T>& values) const {
+	assert_solved_();
+	assert_indices_(indices, values);
+	const long num_components = eigvec_.n_cols;
+	std::vector<double> projected(num_components);
+	for (long c=0; c<num_components; ++c)
+		projected[c] = -projection_offset_(c);
+	for (long k=0; k<long(indices.size()); ++k) {
+		const long j = indices[k];
+		const double value = do_normalize_ ? values[k] / sigma_(j) : values[k];
+		for (long c=0; c<num_components; ++c)
+			projected[c] += value * eigvec_(j, c);
+	}
+	return std::vector<T>(projected.begin(), projected.end());
+}
+
+template<typename T>
+std::vector<T> basic_sparse_pca<T>::to_principal_space(const std::vector<T>& record) const {
+	if (num_vars_ != long(record.size()))
+		throw std::domain_error(utils::join("Record has the wrong size: ", record.size()));
+	std::vector<long> indices;
+	std::vector<T> values;
+	for (long j=0; j<num_vars_; ++j) {
+		if (record[j]==T(0)) continue;
+		indices.push_back(j);
+		values.push_back(record[j]);
+	}
+	return std::move(to_principal_space(indices, values));
+}
+
+template class basic_sparse_pca<float>;
+template class basic_sparse_pca<double>;
+
+} //stats
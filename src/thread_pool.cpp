@@ -0,0 +1,343 @@
+/**
+ * @file thread_pool.cpp
+ * @brief A thread pool shared by the parallel parts of libpca
+ */
+#include "thread_pool.h"
+#include <stdexcept>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <dlfcn.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace stats {
+
+namespace {
+
+thread_local thread_pool* current_pool = nullptr;
+
+thread_local const thread_pool* worker_pool = nullptr;
+thread_local long worker_index = -1;
+
+std::mutex default_pool_mutex;
+
+std::shared_ptr<thread_pool>& default_pool() {
+	static std::shared_ptr<thread_pool> pool = std::make_shared<thread_pool>(std::max(1L, long(std::thread::hardware_concurrency())));
+	return pool;
+}
+
+void pin_current_thread(long cpu) {
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+	(void)cpu;
+#endif
+}
+
+} //anonymous
+
+thread_pool::thread_pool(long num_threads, const std::vector<long>& cpus)
+	: num_threads_(num_threads),
+	  blas_num_threads_(num_threads),
+	  cpus_(cpus),
+	  stop_(false),
+	  num_pending_(0)
+{
+	if (num_threads_ < 1)
+		throw std::invalid_argument("Number of threads smaller than one.");
+	for (long cpu : cpus_)
+		if (cpu < 0)
+			throw std::invalid_argument("Negative CPU index.");
+	// the shared queue followed by one deque per worker
+	for (long i=0; i<=std::max(1L, num_threads_ - 1); ++i)
+		queues_.emplace_back(new task_queue);
+	for (long i=1; i<num_threads_; ++i)
+		workers_.emplace_back(&thread_pool::run_worker_, this, i - 1);
+}
+
+thread_pool::~thread_pool() {
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	condition_.notify_all();
+	for (auto& worker : workers_)
+		worker.join();
+}
+
+long thread_pool::get_num_threads() const {
+	return num_threads_;
+}
+
+const std::vector<long>& thread_pool::get_affinity() const {
+	return cpus_;
+}
+
+void thread_pool::set_blas_num_threads(long num_threads) {
+	if (num_threads < 0)
+		throw std::invalid_argument("Negative number of BLAS threads.");
+	blas_num_threads_ = num_threads;
+}
+
+long thread_pool::get_blas_num_threads() const {
+	return blas_num_threads_;
+}
+
+std::future<void> thread_pool::submit(const std::function<void()>& task) {
+	auto packaged = std::make_shared<std::packaged_task<void()>>(task);
+	std::future<void> result = packaged->get_future();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (workers_.empty())
+			workers_.emplace_back(&thread_pool::run_worker_, this, 0);
+	}
+	push_([packaged]() { (*packaged)(); });
+	return result;
+}
+
+void thread_pool::push_(const std::function<void()>& task) {
+	const long index = worker_pool==this ? worker_index + 1 : 0;
+	++num_pending_;
+	{
+		std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+		queues_[index]->tasks.push_back(task);
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+	}
+	condition_.notify_one();
+}
+
+bool thread_pool::try_pop_(long index, std::function<void()>& task) {
+	const long num_queues = queues_.size();
+	// the own deque from the back, then steal from the front of the
+	// shared queue and the deques of the other workers
+	for (long i=0; i<num_queues; ++i) {
+		const long victim = i==0 ? index + 1 : (index + 1 + i) % num_queues;
+		task_queue& queue = *queues_[victim];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty()) continue;
+		if (i==0) {
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		} else {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		--num_pending_;
+		return true;
+	}
+	return false;
+}
+
+std::shared_ptr<thread_pool> thread_pool::get_default() {
+	std::lock_guard<std::mutex> lock(default_pool_mutex);
+	return default_pool();
+}
+
+void thread_pool::set_default(const std::shared_ptr<thread_pool>& pool) {
+	if (!pool)
+		throw std::invalid_argument("Empty thread pool.");
+	std::lock_guard<std::mutex> lock(default_pool_mutex);
+	default_pool() = pool;
+}
+
+thread_pool& thread_pool::get_current() {
+	if (current_pool)
+		return *current_pool;
+	return *get_default();
+}
+
+void thread_pool::run_worker_(long index) {
+	current_pool = this;
+	worker_pool = this;
+	worker_index = index;
+	if (!cpus_.empty())
+		pin_current_thread(cpus_[index % cpus_.size()]);
+	while (true) {
+		std::function<void()> task;
+		if (try_pop_(index, task)) {
+			task();
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		condition_.wait(lock, [this] { return stop_ || num_pending_>0; });
+		if (stop_ && num_pending_==0) return;
+	}
+}
+
+void thread_pool::run_chunks_(long num_chunks, const std::function<void(long)>& function) {
+	if (num_chunks==1 || num_threads_==1) {
+		for (long chunk=0; chunk<num_chunks; ++chunk)
+			function(chunk);
+		return;
+	}
+
+	struct state {
+		std::atomic<long> next;
+		std::atomic<long> done;
+		std::atomic<bool> failed;
+		std::exception_ptr error;
+		std::mutex mutex;
+		std::condition_variable finished;
+	};
+	auto shared = std::make_shared<state>();
+	shared->next = 0;
+	shared->done = 0;
+	shared->failed = false;
+
+	const std::function<void(long)>* function_ptr = &function;
+	auto work = [shared, function_ptr, num_chunks]() {
+		long chunk;
+		while ((chunk = shared->next++) < num_chunks) {
+			if (!shared->failed) {
+				try {
+					(*function_ptr)(chunk);
+				} catch (...) {
+					std::lock_guard<std::mutex> lock(shared->mutex);
+					if (!shared->failed.exchange(true))
+						shared->error = std::current_exception();
+				}
+			}
+			if (++shared->done == num_chunks) {
+				std::lock_guard<std::mutex> lock(shared->mutex);
+				shared->finished.notify_all();
+			}
+		}
+	};
+
+	const long num_helpers = std::min(num_chunks - 1, num_threads_ - 1);
+	for (long i=0; i<num_helpers; ++i)
+		push_(work);
+
+	work();
+
+	std::unique_lock<std::mutex> lock(shared->mutex);
+	shared->finished.wait(lock, [&shared, num_chunks] { return shared->done==num_chunks; });
+	if (shared->error)
+		std::rethrow_exception(shared->error);
+}
+
+scoped_thread_pool::scoped_thread_pool(const std::shared_ptr<thread_pool>& pool)
+	: pool_(pool),
+	  previous_(current_pool)
+{
+	if (pool_) current_pool = pool_.get();
+}
+
+scoped_thread_pool::~scoped_thread_pool() {
+	current_pool = previous_;
+}
+
+namespace utils {
+
+namespace {
+
+struct blas_threading {
+	void (*set_int)(int);
+	void (*set_long)(long);
+	int (*get_int)();
+	long (*get_long)();
+
+	blas_threading()
+		: set_int(nullptr), set_long(nullptr), get_int(nullptr), get_long(nullptr)
+	{
+		if (lookup_int_("openblas_set_num_threads", "openblas_get_num_threads")) return;
+		if (lookup_int_("MKL_Set_Num_Threads", "MKL_Get_Max_Threads")) return;
+		set_long = reinterpret_cast<void(*)(long)>(dlsym(RTLD_DEFAULT, "bli_thread_set_num_threads"));
+		get_long = reinterpret_cast<long(*)()>(dlsym(RTLD_DEFAULT, "bli_thread_get_num_threads"));
+		if (!set_long || !get_long)
+			set_long = nullptr, get_long = nullptr;
+	}
+
+	bool lookup_int_(const char* set_name, const char* get_name) {
+		set_int = reinterpret_cast<void(*)(int)>(dlsym(RTLD_DEFAULT, set_name));
+		get_int = reinterpret_cast<int(*)()>(dlsym(RTLD_DEFAULT, get_name));
+		if (set_int && get_int) return true;
+		set_int = nullptr, get_int = nullptr;
+		return false;
+	}
+};
+
+const blas_threading& get_blas_threading() {
+	static const blas_threading threading;
+	return threading;
+}
+
+} //anonymous
+
+bool set_blas_num_threads(long num_threads) {
+	const blas_threading& threading = get_blas_threading();
+	if (threading.set_int) {
+		threading.set_int(int(num_threads));
+		return true;
+	}
+	if (threading.set_long) {
+		threading.set_long(num_threads);
+		return true;
+	}
+	return false;
+}
+
+long get_blas_num_threads() {
+	const blas_threading& threading = get_blas_threading();
+	if (threading.get_int)
+		return threading.get_int();
+	if (threading.get_long)
+		return threading.get_long();
+	return 0;
+}
+
+namespace {
+
+// overlapping scopes on several threads share one saved setting
+struct blas_thread_scopes {
+	std::mutex mutex;
+	long num_active;
+	long original;
+
+	blas_thread_scopes()
+		: num_active(0), original(0)
+	{}
+};
+
+blas_thread_scopes& get_blas_thread_scopes() {
+	static blas_thread_scopes scopes;
+	return scopes;
+}
+
+} //anonymous
+
+scoped_blas_threads::scoped_blas_threads(long num_threads)
+	: is_active_(false)
+{
+	if (num_threads <= 0) return;
+	blas_thread_scopes& scopes = get_blas_thread_scopes();
+	std::lock_guard<std::mutex> lock(scopes.mutex);
+	// the first active scope saves the setting and the last one restores it
+	if (scopes.num_active == 0) {
+		scopes.original = get_blas_num_threads();
+		if (scopes.original <= 0) return;
+	}
+	++scopes.num_active;
+	is_active_ = true;
+	if (get_blas_num_threads() != num_threads)
+		set_blas_num_threads(num_threads);
+}
+
+scoped_blas_threads::~scoped_blas_threads() {
+	if (!is_active_) return;
+	blas_thread_scopes& scopes = get_blas_thread_scopes();
+	std::lock_guard<std::mutex> lock(scopes.mutex);
+	if (--scopes.num_active == 0 && get_blas_num_threads() != scopes.original)
+		set_blas_num_threads(scopes.original);
+}
+
+} //utils
+} //stats
@@ -1,19 +1,304 @@
 #include "pca.h"
+#include "simd.h"
+#include "thread_pool.h"
 #include <stdexcept>
 #include <sstream>
 #include <numeric>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <fstream>
+#include <cstdint>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+extern "C" void dspevd_(const char* jobz, const char* uplo, const arma::blas_int* n, double* ap, double* w, double* z,
+						const arma::blas_int* ldz, double* work, const arma::blas_int* lwork, arma::blas_int* iwork,
+						const arma::blas_int* liwork, arma::blas_int* info);
 
 namespace stats {
 namespace utils {
 
-arma::Mat<double> make_covariance_matrix(const arma::Mat<double>& data) {
-	return std::move( (data.t()*data) * (1./(data.n_rows-1)) );
+const long covariance_block_rows = 4096;
+const long covariance_partition_elements = 1L << 24;
+const long packed_block_cols = 256;
+
+template<typename T>
+arma::Mat<double> cross_product_(const arma::Mat<T>& data, long first, long last) {
+	arma::Mat<double> result(data.n_cols, data.n_cols);
+	result.zeros();
+	for (long i=first; i<last; i+=covariance_block_rows) {
+		const long block_last = std::min(i + covariance_block_rows, last) - 1;
+		const arma::Mat<double> rows = arma::conv_to<arma::Mat<double>>::from(data.rows(i, block_last));
+		result += rows.t() * rows;
+	}
+	return std::move(result);
+}
+
+template<>
+arma::Mat<double> cross_product_(const arma::Mat<double>& data, long first, long last) {
+	if (first==0 && last==long(data.n_rows))
+		return std::move( data.t()*data );
+	const arma::Mat<double> rows = data.rows(first, last - 1);
+	return std::move( rows.t()*rows );
 }
 
-arma::Mat<double> make_shuffled_matrix(const arma::Mat<double>& data) {
+template<typename T>
+arma::Mat<double> make_covariance_matrix(const arma::Mat<T>& data) {
 	const long n_rows = data.n_rows;
 	const long n_cols = data.n_cols;
-	arma::Mat<double> shuffle(n_rows, n_cols);
+	const long n_blocks = std::max(1L, (n_rows + covariance_block_rows - 1) / covariance_block_rows);
+	// the partitions depend on the data only so results do not vary with the number of threads
+	const long n_parts = std::max(1L, std::min(n_blocks, covariance_partition_elements / std::max(1L, n_cols * n_cols)));
+	if (n_parts==1)
+		return std::move( cross_product_(data, 0, n_rows) * (1./(n_rows-1)) );
+	thread_pool& pool = thread_pool::get_current();
+	std::vector<arma::Mat<double>> partial(n_parts);
+	{
+		scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+		pool.parallel_for(0, n_parts, 1, [&](long first, long last) {
+			for (long part=first; part<last; ++part) {
+				const long row_first = part * n_blocks / n_parts * covariance_block_rows;
+				const long row_last = std::min(n_rows, (part + 1) * n_blocks / n_parts * covariance_block_rows);
+				partial[part] = cross_product_(data, row_first, row_last);
+			}
+		});
+	}
+	arma::Mat<double> cov_mat = std::move(partial[0]);
+	for (long part=1; part<n_parts; ++part)
+		cov_mat += partial[part];
+	return std::move( cov_mat * (1./(n_rows-1)) );
+}
+
+template<typename T>
+arma::Col<double> make_packed_covariance_matrix(const arma::Mat<T>& data) {
+	const long n_rows = data.n_rows;
+	const long n_cols = data.n_cols;
+	const long n_blocks = (n_cols + packed_block_cols - 1) / packed_block_cols;
+	// each pair of column blocks fills its own part of the upper triangle so
+	// neither partial matrices nor a reduction are needed
+	std::vector<std::pair<long, long>> pairs;
+	for (long col_block=0; col_block<n_blocks; ++col_block)
+		for (long row_block=0; row_block<=col_block; ++row_block)
+			pairs.push_back(std::make_pair(row_block, col_block));
+	arma::Col<double> packed(n_cols * (n_cols + 1) / 2);
+	thread_pool& pool = thread_pool::get_current();
+	scoped_blas_threads blas_threads(pool.get_num_threads()>1 ? 1 : 0);
+	pool.parallel_for(0, pairs.size(), 1, [&](long first, long last) {
+		for (long k=first; k<last; ++k) {
+			const long i_first = pairs[k].first * packed_block_cols;
+			const long i_last = std::min(i_first + packed_block_cols, n_cols);
+			const long j_first = pairs[k].second * packed_block_cols;
+			const long j_last = std::min(j_first + packed_block_cols, n_cols);
+			arma::Mat<double> block(i_last - i_first, j_last - j_first);
+			block.zeros();
+			for (long r=0; r<n_rows; r+=covariance_block_rows) {
+				const long r_last = std::min(r + covariance_block_rows, n_rows) - 1;
+				const arma::Mat<double> left = arma::conv_to<arma::Mat<double>>::from(data.submat(r, i_first, r_last, i_last - 1));
+				const arma::Mat<double> right = arma::conv_to<arma::Mat<double>>::from(data.submat(r, j_first, r_last, j_last - 1));
+				block += left.t() * right;
+			}
+			for (long j=j_first; j<j_last; ++j)
+				for (long i=i_first; i<std::min(i_last, j + 1); ++i)
+					packed[i + j * (j + 1) / 2] = block(i - i_first, j - j_first) / (n_rows - 1);
+		}
+	});
+	return std::move(packed);
+}
+
+void eig_sym_packed(arma::Col<double>& eigval, arma::Mat<double>& eigvec, arma::Col<double>& packed, long num_vars) {
+	if (long(packed.n_elem) != num_vars * (num_vars + 1) / 2)
+		throw std::range_error("Number of elements of packed does not match the number of variables");
+	const char jobz = 'V';
+	const char uplo = 'U';
+	const arma::blas_int n = num_vars;
+	arma::blas_int info = 0;
+	eigval.set_size(num_vars);
+	eigvec.set_size(num_vars, num_vars);
+	// workspace query
+	arma::blas_int lwork = -1;
+	arma::blas_int liwork = -1;
+	double work_size = 0;
+	arma::blas_int iwork_size = 0;
+	dspevd_(&jobz, &uplo, &n, packed.memptr(), eigval.memptr(), eigvec.memptr(), &n, &work_size, &lwork, &iwork_size, &liwork, &info);
+	if (info != 0)
+		throw std::runtime_error(join("Packed eigensolver failed with info: ", info));
+	lwork = arma::blas_int(work_size);
+	liwork = iwork_size;
+	std::vector<double> work(lwork);
+	std::vector<arma::blas_int> iwork(liwork);
+	dspevd_(&jobz, &uplo, &n, packed.memptr(), eigval.memptr(), eigvec.memptr(), &n, &work[0], &lwork, &iwork[0], &liwork, &info);
+	if (info != 0)
+		throw std::runtime_error(join("Packed eigensolver failed with info: ", info));
+}
+
+void refine_symmetric_eigenpairs(arma::Col<double>& eigval, arma::Mat<double>& eigvec,
+								 const arma::Mat<double>& mat, long num_iter) {
+	const long n = mat.n_rows;
+	if (long(mat.n_cols)!=n || long(eigvec.n_rows)!=n || long(eigvec.n_cols)!=n || long(eigval.n_elem)!=n)
+		throw std::range_error("Dimensions of eigenpairs and matrix do not match");
+	const double mat_norm = arma::norm(mat, "fro");
+	arma::Mat<double> prod;
+	for (long iter=0; iter<num_iter; ++iter) {
+		prod = mat * eigvec;
+		const arma::Mat<double> ortho = arma::eye(n, n) - eigvec.t() * eigvec;
+		const arma::Mat<double> rayleigh = eigvec.t() * prod;
+		for (long i=0; i<n; ++i)
+			eigval(i) = rayleigh(i, i) / (1 - ortho(i, i));
+		double off_norm = 0;
+		for (long j=0; j<n; ++j)
+			for (long i=0; i<n; ++i)
+				if (i!=j) off_norm += rayleigh(i, j) * rayleigh(i, j);
+		const double delta = 2 * (std::sqrt(off_norm) + mat_norm * arma::norm(ortho, "fro"));
+		arma::Mat<double> correction(n, n);
+		for (long j=0; j<n; ++j) {
+			for (long i=0; i<n; ++i) {
+				const double gap = eigval(j) - eigval(i);
+				if (i!=j && std::abs(gap)>delta)
+					correction(i, j) = (rayleigh(i, j) + eigval(j) * ortho(i, j)) / gap;
+				else
+					correction(i, j) = ortho(i, j) / 2;
+			}
+		}
+		eigvec += eigvec * correction;
+	}
+	prod = mat * eigvec;
+	for (long i=0; i<n; ++i)
+		eigval(i) = arma::dot(eigvec.col(i), prod.col(i)) / arma::dot(eigvec.col(i), eigvec.col(i));
+}
+
+namespace {
+
+const double em_expected_iterations = 50;
+const long benchmark_records = 512;
+const long benchmark_vars = 64;
+
+struct solver_rates {
+	double product;      // seconds per multiply-add of a matrix product
+	double eigen;        // seconds per p^3 of a divide and conquer eigensolve
+	double eigen_std;    // seconds per p^3 of a standard eigensolve
+	double eigen_single; // seconds per p^3 of a single precision eigensolve
+	double qr;           // seconds per n p^2 of a thin QR factorization
+	double svd;          // seconds per n p^2 of a thin singular value decomposition
+};
+
+template<typename Function>
+double measure_seconds_(const Function& function) {
+	// the fastest of a few runs is least disturbed by other processes
+	double best = std::numeric_limits<double>::max();
+	for (int run=0; run<3; ++run) {
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+	return std::max(best, 1e-9);
+}
+
+solver_rates measure_solver_rates_() {
+	const scoped_blas_threads blas_threads(1);
+	const double n = benchmark_records;
+	const double p = benchmark_vars;
+	arma::Mat<double> data(benchmark_records, benchmark_vars);
+	std::mt19937 generator(1);
+	std::normal_distribution<double> distribution;
+	for (long i=0; i<long(data.n_elem); ++i)
+		data[i] = distribution(generator);
+	const arma::Mat<double> cov_mat = data.t() * data * (1./(n - 1));
+	const arma::Mat<float> cov_single = arma::conv_to<arma::Mat<float>>::from(cov_mat);
+
+	solver_rates rates;
+	arma::Mat<double> result;
+	rates.product = measure_seconds_([&]() { result = data.t() * data; }) / (n * p * p);
+	arma::Col<double> eigval;
+	arma::Mat<double> eigvec;
+	rates.eigen = measure_seconds_([&]() { arma::eig_sym(eigval, eigvec, cov_mat, "dc"); }) / (p * p * p);
+	rates.eigen_std = measure_seconds_([&]() { arma::eig_sym(eigval, eigvec, cov_mat, "std"); }) / (p * p * p);
+	arma::Col<float> eigval_single;
+	arma::Mat<float> eigvec_single;
+	rates.eigen_single = measure_seconds_([&]() { arma::eig_sym(eigval_single, eigvec_single, cov_single, "dc"); }) / (p * p * p);
+	arma::Mat<double> q;
+	arma::Mat<double> r;
+	rates.qr = measure_seconds_([&]() { arma::qr_econ(q, r, data); }) / (n * p * p);
+	arma::Mat<double> left;
+	arma::Col<double> singular;
+	arma::Mat<double> right;
+	rates.svd = measure_seconds_([&]() { arma::svd_econ(left, singular, right, data, "both", "dc"); }) / (n * p * p);
+	return rates;
+}
+
+const solver_rates& get_solver_rates_() {
+	static const solver_rates rates = measure_solver_rates_();
+	return rates;
+}
+
+double get_available_memory_() {
+#ifdef _SC_AVPHYS_PAGES
+	const long pages = sysconf(_SC_AVPHYS_PAGES);
+	const long page_size = sysconf(_SC_PAGESIZE);
+	if (pages>0 && page_size>0)
+		return double(pages) * page_size;
+#endif
+	return std::numeric_limits<double>::max();
+}
+
+} //anonymous
+
+double estimate_solve_seconds(const std::string& solver, long num_records, long num_vars, long num_components, long num_threads) {
+	if (num_records<2 || num_vars<1 || num_components<1 || num_threads<1)
+		throw std::invalid_argument(join("Invalid shape for a cost estimate: ", num_records, " records, ", num_vars, " variables, ",
+										 num_components, " components, ", num_threads, " threads"));
+	const solver_rates& rates = get_solver_rates_();
+	const double n = num_records;
+	const double p = num_vars;
+	const double k = std::min(num_components, num_vars);
+	const double t = num_threads;
+	// covariance and QR blocks are spread over the threads; eigensolves run on one
+	const double covariance = n * p * p * rates.product / t;
+	const double projection = n * p * p * rates.product;
+	if (solver=="dc" || solver=="packed")
+		return covariance + p * p * p * rates.eigen + projection;
+	if (solver=="standard")
+		return covariance + p * p * p * rates.eigen_std + projection;
+	if (solver=="mixed")
+		return covariance + p * p * p * (rates.eigen_single + 6 * rates.product) + projection;
+	if (solver=="em")
+		return em_expected_iterations * 4 * n * p * k * rates.product + projection * k / p;
+	if (solver=="tsqr")
+		return n * p * p * rates.qr / t + p * p * p * rates.svd + projection;
+	if (solver=="svd")
+		return n * p * p * rates.svd;
+	throw std::invalid_argument(join("No such solver available: ", solver));
+}
+
+std::string choose_solver(long num_records, long num_vars, long num_threads) {
+	const double memory = get_available_memory_() / 2;
+	// the svd keeps a double precision copy of the records and the left singular vectors
+	const bool svd_fits = 8. * num_records * (num_vars + std::min(num_records, num_vars)) < memory;
+	// a full eigensolve needs the covariance matrix, the eigenvectors and a workspace of twice their size
+	const bool dense_fits = 32. * num_vars * num_vars < memory;
+	std::string best;
+	double best_seconds = 0;
+	// only solvers returning all eigenpairs like dc are candidates
+	for (const std::string solver : {"dc", "packed", "tsqr", "svd"}) {
+		if ((solver=="tsqr" || solver=="svd") && num_records < num_vars) continue;
+		if (solver=="svd" && !svd_fits) continue;
+		if (solver=="dc" && !dense_fits) continue;
+		if (solver=="packed" && dense_fits) continue;
+		const double seconds = estimate_solve_seconds(solver, num_records, num_vars, num_vars, num_threads);
+		if (best.empty() || seconds < best_seconds) {
+			best = solver;
+			best_seconds = seconds;
+		}
+	}
+	return best;
+}
+
+template<typename T>
+arma::Mat<T> make_shuffled_matrix(const arma::Mat<T>& data) {
+	const long n_rows = data.n_rows;
+	const long n_cols = data.n_cols;
+	arma::Mat<T> shuffle(n_rows, n_cols);
 	for (long j=0; j<n_cols; ++j) {
 	    for (long i=0; i<n_rows; ++i) {
 	    	shuffle(i, j) = data(std::rand()%n_rows, j);
@@ -22,45 +307,183 @@ arma::Mat<double> make_shuffled_matrix(const arma::Mat<double>& data) {
     return std::move(shuffle);
 }
 
-arma::Col<double> compute_column_means(const arma::Mat<double>& data) {
+template<typename T>
+arma::Mat<T> make_shuffled_matrix(const arma::Mat<T>& data, std::mt19937& generator) {
+	const long n_rows = data.n_rows;
+	const long n_cols = data.n_cols;
+	arma::Mat<T> shuffle(n_rows, n_cols);
+	std::uniform_int_distribution<long> distribution(0, std::max(0L, n_rows - 1));
+	for (long j=0; j<n_cols; ++j) {
+		for (long i=0; i<n_rows; ++i) {
+			shuffle(i, j) = data(distribution(generator), j);
+		}
+	}
+	return std::move(shuffle);
+}
+
+const long column_block_rows = 65536;
+const long column_block_elements = 32768;
+
+template<typename T, typename Function>
+void for_each_column_block_(const arma::Mat<T>& data, const Function& function) {
+	const long n_rows = data.n_rows;
+	const long n_cols = data.n_cols;
+	const long n_blocks = std::max(1L, (n_rows + column_block_rows - 1) / column_block_rows);
+	const long grain = std::max(1L, column_block_elements / std::max(1L, std::min(n_rows, column_block_rows)));
+	thread_pool::get_current().parallel_for(0, n_cols * n_blocks, grain, [&](long first, long last) {
+		for (long task=first; task<last; ++task) {
+			const long col = task / n_blocks;
+			const long block = task % n_blocks;
+			const long row = block * column_block_rows;
+			function(col, block, row, std::min(column_block_rows, n_rows - row));
+		}
+	});
+}
+
+template<typename T, typename Kernel>
+arma::Col<double> reduce_columns_(const arma::Mat<T>& data, const Kernel& kernel) {
+	const long n_rows = data.n_rows;
 	const long n_cols = data.n_cols;
-	arma::Col<double> means(n_cols);
+	const long n_blocks = std::max(1L, (n_rows + column_block_rows - 1) / column_block_rows);
+	arma::Mat<double> partial(n_blocks, n_cols);
+	for_each_column_block_(data, [&](long col, long block, long row, long count) {
+		partial(block, col) = kernel(data.colptr(col) + row, count);
+	});
+	arma::Col<double> result(n_cols);
+	for (long col=0; col<n_cols; ++col) {
+		double sum = 0;
+		for (long block=0; block<n_blocks; ++block)
+			sum += partial(block, col);
+		result(col) = sum;
+	}
+	return std::move(result);
+}
+
+template<typename T>
+arma::Col<T> compute_column_means(const arma::Mat<T>& data) {
+	const long n_rows = data.n_rows;
+	const long n_cols = data.n_cols;
+	const arma::Col<double> sums = reduce_columns_(data, simd::get_kernels<T>().sum);
+	arma::Col<T> means(n_cols);
 	for (long i=0; i<n_cols; ++i)
-    	means(i) = arma::mean(data.col(i));
+		means(i) = sums(i) / n_rows;
 	return std::move(means);
 }
 
-void remove_column_means(arma::Mat<double>& data, const arma::Col<double>& means) {
+template<typename T>
+void remove_column_means(arma::Mat<T>& data, const arma::Col<T>& means) {
 	if (data.n_cols != means.n_elem)
 		throw std::range_error("Number of elements of means is not equal to the number of columns of data");
-    for (long i=0; i<long(data.n_cols); ++i)
-    	data.col(i) -= means(i);
+	const auto& kernels = simd::get_kernels<T>();
+	for_each_column_block_(data, [&](long col, long block, long row, long count) {
+		kernels.subtract(data.colptr(col) + row, count, means(col));
+	});
 }
 
-arma::Col<double> compute_column_rms(const arma::Mat<double>& data) {
+template<typename T>
+arma::Col<T> compute_column_rms(const arma::Mat<T>& data) {
+	const long n_rows = data.n_rows;
 	const long n_cols = data.n_cols;
-	arma::Col<double> rms(n_cols);
-    for (long i=0; i<n_cols; ++i) {
-        const double dot = arma::dot(data.col(i), data.col(i));
-        rms(i) = std::sqrt(dot / (data.col(i).n_rows-1));
-    }
+	const arma::Col<double> dots = reduce_columns_(data, simd::get_kernels<T>().sum_squares);
+	arma::Col<T> rms(n_cols);
+	for (long i=0; i<n_cols; ++i)
+		rms(i) = std::sqrt(dots(i) / (n_rows-1));
 	return std::move(rms);
 }
 
-void normalize_by_column(arma::Mat<double>& data, const arma::Col<double>& rms) {
+template<typename T>
+void normalize_by_column(arma::Mat<T>& data, const arma::Col<T>& rms) {
 	if (data.n_cols != rms.n_elem)
 		throw std::range_error("Number of elements of rms is not equal to the number of columns of data");
 	for (long i=0; i<long(data.n_cols); ++i) {
         if (rms(i)==0)
         	throw std::runtime_error("At least one of the entries of rms equals to zero");
-        data.col(i) *= 1./rms(i);
     }
+	const auto& kernels = simd::get_kernels<T>();
+	for_each_column_block_(data, [&](long col, long block, long row, long count) {
+		kernels.scale(data.colptr(col) + row, count, 1./rms(col));
+	});
 }
 
-void enforce_positive_sign_by_column(arma::Mat<double>& data) {
+namespace {
+
+const int mpol_interleave = 3;
+
+std::vector<long> get_online_numa_nodes_() {
+	std::vector<long> nodes;
+	std::ifstream file("/sys/devices/system/node/online");
+	std::string range;
+	while (std::getline(file, range, ',')) {
+		const auto dash = range.find('-');
+		const long first = std::atol(range.c_str());
+		const long last = dash==std::string::npos ? first : std::atol(range.c_str() + dash + 1);
+		for (long node=first; node<=last; ++node)
+			nodes.push_back(node);
+	}
+	if (nodes.empty()) nodes.push_back(0);
+	return std::move(nodes);
+}
+
+void place_pages_(void* memory, long bytes, const std::string& placement, bool use_huge_pages) {
+	const long page_size = sysconf(_SC_PAGESIZE);
+	if (page_size<=0) return;
+	// only whole pages inside the block may be advised
+	const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(memory);
+	const std::uintptr_t first = (address + page_size - 1) / page_size * page_size;
+	const std::uintptr_t last = (address + bytes) / page_size * page_size;
+	if (last <= first) return;
+	void* begin = reinterpret_cast<void*>(first);
+	const std::size_t length = last - first;
+#ifdef MADV_HUGEPAGE
+	if (use_huge_pages) madvise(begin, length, MADV_HUGEPAGE);
+#endif
+#ifdef SYS_mbind
+	if (placement=="interleave") {
+		const std::vector<long> nodes = get_online_numa_nodes_();
+		if (nodes.size() > 1) {
+			const long mask_bits = 8 * sizeof(unsigned long);
+			std::vector<unsigned long> mask(nodes.back() / mask_bits + 1);
+			for (long node : nodes)
+				mask[node / mask_bits] |= 1UL << (node % mask_bits);
+			syscall(SYS_mbind, begin, length, mpol_interleave, mask.data(), mask.size() * mask_bits + 1, 0);
+		}
+	}
+#endif
+}
+
+} //anonymous
+
+long get_num_numa_nodes() {
+	return get_online_numa_nodes_().size();
+}
+
+template<typename T>
+void resize_placed(arma::Mat<T>& data, long n_rows, long n_cols, const std::string& placement, bool use_huge_pages, T* memory) {
+	if (placement!="default" && placement!="first_touch" && placement!="interleave")
+		throw std::invalid_argument(join("No such memory placement available: ", placement));
+	if (placement=="default" && !use_huge_pages && !memory) {
+		data.resize(n_rows, n_cols);
+		return;
+	}
+	arma::Mat<T> placed = memory ? arma::Mat<T>(memory, n_rows, n_cols, false, false) : arma::Mat<T>(n_rows, n_cols, arma::fill::none);
+	place_pages_(placed.memptr(), placed.n_elem * sizeof(T), placement, use_huge_pages);
+	const long copy_rows = std::min(n_rows, long(data.n_rows));
+	const long copy_cols = std::min(n_cols, long(data.n_cols));
+	for_each_column_block_(placed, [&](long col, long block, long row, long count) {
+		T* target = placed.colptr(col) + row;
+		const long num_copied = col<copy_cols ? std::max(0L, std::min(count, copy_rows - row)) : 0;
+		if (num_copied > 0)
+			std::copy(data.colptr(col) + row, data.colptr(col) + row + num_copied, target);
+		std::fill(target + num_copied, target + count, T(0));
+	});
+	data = std::move(placed);
+}
+
+template<typename T>
+void enforce_positive_sign_by_column(arma::Mat<T>& data) {
 	for (long i=0; i<long(data.n_cols); ++i) {
-		const double max = arma::max(data.col(i));
-		const double min = arma::min(data.col(i));
+		const T max = arma::max(data.col(i));
+		const T min = arma::min(data.col(i));
 		bool change_sign = false;
 		if (std::abs(max)>=std::abs(min)) {
 			if (max<0) change_sign = true;
@@ -71,22 +494,35 @@ void enforce_positive_sign_by_column(arma::Mat<double>& data) {
 	}
 }
 
-std::vector<double> extract_column_vector(const arma::Mat<double>& data, long index) {
+template<typename T>
+std::vector<T> extract_column_vector(const arma::Mat<T>& data, long index) {
 	if (index<0 || index >= long(data.n_cols))
 		throw std::range_error(join("Index out of range: ", index));
 	const long n_rows = data.n_rows;
-	const double* memptr = data.colptr(index);
-	std::vector<double> result(memptr, memptr + n_rows);
+	const T* memptr = data.colptr(index);
+	std::vector<T> result(memptr, memptr + n_rows);
 	return std::move(result);
 }
 
-std::vector<double> extract_row_vector(const arma::Mat<double>& data, long index) {
+template<typename T>
+std::vector<T> extract_row_vector(const arma::Mat<T>& data, long index) {
 	if (index<0 || index >= long(data.n_rows))
 		throw std::range_error(join("Index out of range: ", index));
-	const arma::Row<double> row(data.row(index));
-	const double* memptr = row.memptr();
-	std::vector<double> result(memptr, memptr + row.n_elem);
-	return std::move(result);
+	return std::move(view_row(data, index).to_vector());
+}
+
+template<typename T>
+vector_view<T> view_column(const arma::Mat<T>& data, long index) {
+	if (index<0 || index >= long(data.n_cols))
+		throw std::range_error(join("Index out of range: ", index));
+	return vector_view<T>(data.colptr(index), data.n_rows);
+}
+
+template<typename T>
+vector_view<T> view_row(const arma::Mat<T>& data, long index) {
+	if (index<0 || index >= long(data.n_rows))
+		throw std::range_error(join("Index out of range: ", index));
+	return vector_view<T>(data.memptr() + index, data.n_cols, data.n_rows);
 }
 
 void assert_file_good(const bool& is_file_good, const std::string& filename) {
@@ -107,5 +543,34 @@ double get_sigma(const std::vector<double>& iter) {
 	return std::sqrt(sum/(iter.size()-1));
 }
 
+template arma::Mat<double> make_covariance_matrix(const arma::Mat<float>&);
+template arma::Mat<double> make_covariance_matrix(const arma::Mat<double>&);
+template arma::Col<double> make_packed_covariance_matrix(const arma::Mat<float>&);
+template arma::Col<double> make_packed_covariance_matrix(const arma::Mat<double>&);
+template arma::Mat<float> make_shuffled_matrix(const arma::Mat<float>&);
+template arma::Mat<double> make_shuffled_matrix(const arma::Mat<double>&);
+template arma::Mat<float> make_shuffled_matrix(const arma::Mat<float>&, std::mt19937&);
+template arma::Mat<double> make_shuffled_matrix(const arma::Mat<double>&, std::mt19937&);
+template arma::Col<float> compute_column_means(const arma::Mat<float>&);
+template arma::Col<double> compute_column_means(const arma::Mat<double>&);
+template void remove_column_means(arma::Mat<float>&, const arma::Col<float>&);
+template void remove_column_means(arma::Mat<double>&, const arma::Col<double>&);
+template arma::Col<float> compute_column_rms(const arma::Mat<float>&);
+template arma::Col<double> compute_column_rms(const arma::Mat<double>&);
+template void normalize_by_column(arma::Mat<float>&, const arma::Col<float>&);
+template void normalize_by_column(arma::Mat<double>&, const arma::Col<double>&);
+template void resize_placed(arma::Mat<float>&, long, long, const std::string&, bool, float*);
+template void resize_placed(arma::Mat<double>&, long, long, const std::string&, bool, double*);
+template void enforce_positive_sign_by_column(arma::Mat<float>&);
+template void enforce_positive_sign_by_column(arma::Mat<double>&);
+template std::vector<float> extract_column_vector(const arma::Mat<float>&, long);
+template std::vector<double> extract_column_vector(const arma::Mat<double>&, long);
+template std::vector<float> extract_row_vector(const arma::Mat<float>&, long);
+template std::vector<double> extract_row_vector(const arma::Mat<double>&, long);
+template vector_view<float> view_column(const arma::Mat<float>&, long);
+template vector_view<double> view_column(const arma::Mat<double>&, long);
+template vector_view<float> view_row(const arma::Mat<float>&, long);
+template vector_view<double> view_row(const arma::Mat<double>&, long);
+
 } //utils
 } //stats
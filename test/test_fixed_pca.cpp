@@ -0,0 +1,94 @@
+/**
+ * @file test_fixed_pca.cpp
+ * @brief Unit tests for the class template stats::fixed_pca
+ */
+#include "test_fixed_pca.h"
+
+using namespace std;
+
+void test_fixed_pca::add_records(stats::fixed_pca<4>& pca) const {
+	for (auto record : records)
+		pca.add_record({record[0], record[1], record[2], record[3]});
+}
+
+void test_fixed_pca::test_add_record() {
+	stats::fixed_pca<4> pca;
+	assert_equal(4, pca.get_num_variables(), SPOT);
+	add_records(pca);
+	assert_equal(4, pca.get_num_records(), SPOT);
+	const vector<double> exp_mean = {118, 114.175, 46.5, 7.25};
+	const auto mean = pca.get_mean_values();
+	assert_approx_equal_containers(exp_mean, mean, utils::feps, SPOT);
+}
+
+void test_fixed_pca::test_solve_throws() {
+	stats::fixed_pca<3> pca;
+	pca.add_record({1, 2, 3});
+	assert_throw<std::logic_error>(std::bind(&stats::fixed_pca<3>::solve, pca), SPOT);
+}
+
+void test_fixed_pca::test_set_num_retained() {
+	stats::fixed_pca<3> pca;
+	assert_equal(3, pca.get_num_retained(), SPOT);
+	pca.set_num_retained(2);
+	assert_equal(2, pca.get_num_retained(), SPOT);
+	assert_throw<std::range_error>(std::bind(&stats::fixed_pca<3>::set_num_retained, pca, 4), SPOT);
+	assert_throw<std::range_error>(std::bind(&stats::fixed_pca<3>::set_num_retained, pca, 0), SPOT);
+}
+
+void test_fixed_pca::test_eigen_same_as_pca() {
+	for (bool do_normalize : {false, true}) {
+		stats::pca pca(4);
+		pca.set_do_normalize(do_normalize);
+		for (auto record : records)
+			pca.add_record(record);
+		pca.solve();
+
+		stats::fixed_pca<4> fixed;
+		fixed.set_do_normalize(do_normalize);
+		add_records(fixed);
+		fixed.solve();
+
+		const double eps = 1e-9;
+		assert_approx_equal(pca.get_energy(), fixed.get_energy(), pca.get_energy()*eps, SPOT);
+		const auto eigval = fixed.get_eigenvalues();
+		assert_approx_equal_containers(pca.get_eigenvalues(), eigval, eps, SPOT);
+		for (long i=0; i<4; ++i) {
+			const auto eigvec = fixed.get_eigenvector(i);
+			assert_approx_equal_containers(pca.get_eigenvector(i), eigvec, 1e-7, SPOT);
+		}
+		const auto sigma = fixed.get_sigma_values();
+		assert_approx_equal_containers(pca.get_sigma_values(), sigma, 1e-9, SPOT);
+	}
+}
+
+void test_fixed_pca::test_projections_to_space() {
+	stats::fixed_pca<4> pca;
+	pca.set_do_normalize(true);
+	add_records(pca);
+	pca.solve();
+	for (auto record : records) {
+		const stats::fixed_pca<4>::record_type rec = {record[0], record[1], record[2], record[3]};
+		const auto back = pca.to_variable_space(pca.to_principal_space(rec));
+		assert_approx_equal_containers(rec, back, 1e-9, SPOT);
+	}
+	pca.set_num_retained(2);
+	const stats::fixed_pca<4>::record_type rec = {1, 2.5, 42, 7};
+	const auto prin = pca.to_principal_space(rec);
+	assert_equal(0., prin[2], SPOT);
+	assert_equal(0., prin[3], SPOT);
+}
+
+void test_fixed_pca::test_eig_sym_jacobi() {
+	arma::Mat<double>::fixed<3, 3> mat;
+	mat.at(0, 0) = 4; mat.at(0, 1) = 1; mat.at(0, 2) = 0;
+	mat.at(1, 0) = 1; mat.at(1, 1) = 3; mat.at(1, 2) = 1;
+	mat.at(2, 0) = 0; mat.at(2, 1) = 1; mat.at(2, 2) = 2;
+	arma::Col<double>::fixed<3> eigval;
+	arma::Mat<double>::fixed<3, 3> eigvec;
+	stats::utils::eig_sym_jacobi<3>(eigval, eigvec, mat);
+	const vector<double> exp_eigval = {3 - std::sqrt(3.), 3, 3 + std::sqrt(3.)};
+	assert_approx_equal_containers(exp_eigval, eigval, 1e-12, SPOT);
+	const arma::Mat<double> diff = mat * eigvec - eigvec * arma::diagmat(eigval);
+	assert_approx_equal(0., arma::norm(diff, "fro"), 1e-12, SPOT);
+}
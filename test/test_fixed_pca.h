@@ -0,0 +1,34 @@
+#pragma once
+/**
+ * @file test_fixed_pca.h
+ * @brief Unit tests for the class template stats::fixed_pca
+ */
+#include "fixed_pca.h"
+#include "utils.hpp"
+
+
+struct test_fixed_pca : utils::mytestcase {
+
+	static void run() {
+		RUN(test_fixed_pca, test_add_record)
+		RUN(test_fixed_pca, test_solve_throws)
+		RUN(test_fixed_pca, test_set_num_retained)
+		RUN(test_fixed_pca, test_eigen_same_as_pca)
+		RUN(test_fixed_pca, test_projections_to_space)
+		RUN(test_fixed_pca, test_eig_sym_jacobi)
+	}
+
+	void test_add_record();
+	void test_solve_throws();
+	void test_set_num_retained();
+	void test_eigen_same_as_pca();
+	void test_projections_to_space();
+	void test_eig_sym_jacobi();
+
+private:
+	const std::vector<std::vector<double>> records = {{1, 2.5, 42, 7},
+													  {3, 4.2, 90, 7},
+													  {456, 444, 0, 7},
+													  {12, 6, 54, 8}};
+	void add_records(stats::fixed_pca<4>& pca) const;
+};
@@ -0,0 +1,69 @@
+/**
+ * @file test_grouped_pca.cpp
+ * @brief Unit tests for the class template stats::grouped_pca
+ */
+#include "test_grouped_pca.h"
+#include <map>
+
+using namespace std;
+
+void test_grouped_pca::test_constructor_throws() {
+	struct Functor {
+	    void operator()(long arg1) {
+		stats::grouped_pca<string> pca(arg1);
+	}} functor;
+	assert_throw<std::invalid_argument>(std::bind(functor, 1), SPOT);
+	assert_no_throw(std::bind(functor, 2), SPOT);
+}
+
+void test_grouped_pca::test_add_record() {
+	stats::grouped_pca<string> pca(3);
+	assert_equal(3, pca.get_num_variables(), SPOT);
+	pca.add_record("b", {1, 2, 3});
+	pca.add_record("a", {4, 5, 6});
+	pca.add_record("b", {7, 8, 9});
+	assert_equal(2, pca.get_num_groups(), SPOT);
+	const vector<string> exp = {"b", "a"};
+	assert_equal_containers(exp, pca.get_keys(), SPOT);
+	assert_equal(2, pca.get_num_records("b"), SPOT);
+	assert_equal(1, pca.get_num_records("a"), SPOT);
+	assert_true(pca.has_group("a"), SPOT);
+	assert_false(pca.has_group("c"), SPOT);
+	assert_throw<std::domain_error>([&pca]() { pca.add_record("c", {1, 2}); }, SPOT);
+	assert_false(pca.has_group("c"), SPOT);
+}
+
+void test_grouped_pca::test_missing_group_throws() {
+	stats::grouped_pca<long> pca(2);
+	pca.add_record(1, {1, 2});
+	pca.add_record(1, {2, 5});
+	pca.solve();
+	assert_no_throw([&pca]() { pca.get_eigenvalues(1); }, SPOT);
+	assert_throw<std::domain_error>([&pca]() { pca.get_eigenvalues(2); }, SPOT);
+	assert_throw<std::domain_error>([&pca]() { pca.to_principal_space(2, {1, 2}); }, SPOT);
+}
+
+void test_grouped_pca::test_same_as_pca() {
+	const long nvar = 5;
+	stats::grouped_pca<long, float> grouped(nvar);
+	grouped.set_num_threads(3);
+	map<long, stats::fpca> singles;
+	for (long r=0; r<600; ++r) {
+		const long key = (r * 7919) % 13;
+		vector<float> record(nvar);
+		for (long j=0; j<nvar; ++j)
+			record[j] = ((r * (j + 2) + key) % 11) * (j + 1) + 0.5 * (r % 3);
+		grouped.add_record(key, record);
+		if (!singles.count(key)) singles.insert(make_pair(key, stats::fpca(nvar)));
+		singles.find(key)->second.add_record(record);
+	}
+	grouped.solve();
+	assert_equal(13, grouped.get_num_groups(), SPOT);
+	for (auto& single : singles) {
+		single.second.solve();
+		const float eps = 1e-3;
+		assert_approx_equal_containers(single.second.get_eigenvalues(), grouped.get_eigenvalues(single.first), eps, SPOT);
+		assert_approx_equal_containers(single.second.get_mean_values(), grouped.get_mean_values(single.first), eps, SPOT);
+		assert_approx_equal_containers(single.second.get_eigenvector(0), grouped.get_eigenvector(single.first, 0), eps, SPOT);
+	}
+}
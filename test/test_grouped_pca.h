@@ -0,0 +1,23 @@
+#pragma once
+/**
+ * @file test_grouped_pca.h
+ * @brief Unit tests for the class template stats::grouped_pca
+ */
+#include "grouped_pca.h"
+#include "utils.hpp"
+
+
+struct test_grouped_pca : utils::mytestcase {
+
+	static void run() {
+		RUN(test_grouped_pca, test_constructor_throws)
+		RUN(test_grouped_pca, test_add_record)
+		RUN(test_grouped_pca, test_missing_group_throws)
+		RUN(test_grouped_pca, test_same_as_pca)
+	}
+
+	void test_constructor_throws();
+	void test_add_record();
+	void test_missing_group_throws();
+	void test_same_as_pca();
+};
@@ -0,0 +1,113 @@
+/**
+ * @file test_kernel_pca.cpp
+ * @brief Unit tests for the class template stats::basic_kernel_pca
+ */
+#include "test_kernel_pca.h"
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+vector<vector<double>> make_records(long num_records, long num_vars) {
+	vector<vector<double>> records(num_records, vector<double>(num_vars));
+	for (long i=0; i<num_records; ++i)
+		for (long j=0; j<num_vars; ++j)
+			records[i][j] = std::sin(0.37 * i * (j + 1) + j) * (j + 1) + 0.1 * ((i * 7 + j * 3) % 5);
+	return std::move(records);
+}
+
+}
+
+void test_kernel_pca::test_setters_throw() {
+	assert_throw<std::invalid_argument>([]() { stats::kernel_pca pca(0); }, SPOT);
+	stats::kernel_pca pca(2);
+	assert_equal("rbf", pca.get_kernel(), SPOT);
+	assert_throw<std::invalid_argument>([&pca]() { pca.set_kernel("linear"); }, SPOT);
+	assert_throw<std::invalid_argument>([&pca]() { pca.set_gamma(-1); }, SPOT);
+	assert_throw<std::invalid_argument>([&pca]() { pca.set_degree(0); }, SPOT);
+	assert_throw<std::invalid_argument>([&pca]() { pca.set_num_landmarks(1); }, SPOT);
+	assert_throw<std::domain_error>([&pca]() { pca.add_record({1, 2, 3}); }, SPOT);
+	assert_throw<std::domain_error>([&pca]() { pca.add_record({1, std::nan("")}); }, SPOT);
+	assert_throw<std::domain_error>([&pca]() { pca.add_record({INFINITY, 2}); }, SPOT);
+	assert_equal(0, pca.get_num_records(), SPOT);
+	pca.set_kernel("polynomial");
+	assert_equal("polynomial", pca.get_kernel(), SPOT);
+}
+
+void test_kernel_pca::test_solve_throws() {
+	stats::kernel_pca pca(2);
+	pca.add_record({1, 2});
+	assert_throw<std::logic_error>([&pca]() { pca.solve(); }, SPOT);
+	assert_throw<std::logic_error>([&pca]() { pca.to_principal_space(vector<double>{1, 2}); }, SPOT);
+	pca.add_record({2, 1});
+	assert_no_throw([&pca]() { pca.solve(); }, SPOT);
+}
+
+void test_kernel_pca::test_linear_kernel_same_as_pca() {
+	const long nvar = 4;
+	const auto records = make_records(60, nvar);
+	stats::pca linear(nvar);
+	stats::kernel_pca kernel(nvar);
+	kernel.set_kernel("polynomial");
+	kernel.set_degree(1);
+	kernel.set_gamma(1);
+	kernel.set_coef0(0);
+	kernel.set_num_landmarks(100);
+	for (const auto& record : records) {
+		linear.add_record(record);
+		kernel.add_record(record);
+	}
+	linear.solve();
+	kernel.solve();
+	// with all records as landmarks the Nystroem approximation of a linear kernel is exact
+	assert_equal(nvar, kernel.get_num_components(), SPOT);
+	for (long i=0; i<nvar; ++i)
+		assert_approx_equal(linear.get_eigenvalue(i), kernel.get_eigenvalue(i), 1e-8, SPOT);
+	for (long r=0; r<10; ++r) {
+		const auto exp = linear.to_principal_space(records[r]);
+		const auto act = kernel.to_principal_space(records[r]);
+		for (long i=0; i<nvar; ++i)
+			assert_approx_equal(std::abs(exp[i]), std::abs(act[i]), 1e-6, SPOT);
+	}
+}
+
+void test_kernel_pca::test_batch_projection() {
+	const long nvar = 3;
+	const auto records = make_records(700, nvar);
+	stats::kernel_pca serial(nvar);
+	serial.set_num_landmarks(40, 7);
+	serial.set_gamma(0.5);
+	serial.set_num_threads(1);
+	for (const auto& record : records)
+		serial.add_record(record);
+	stats::kernel_pca parallel(serial);
+	parallel.set_num_threads(3);
+	serial.solve();
+	parallel.solve();
+	assert_equal(serial.get_num_components(), parallel.get_num_components(), SPOT);
+	assert_approx_equal_containers(serial.get_eigenvalues(), parallel.get_eigenvalues(), 1e-12, SPOT);
+
+	const auto projected = parallel.to_principal_space(records);
+	assert_equal(long(records.size()), long(projected.size()), SPOT);
+	const auto first = parallel.get_principal(0);
+	for (long r=0; r<long(records.size()); r+=50) {
+		assert_approx_equal_containers(serial.to_principal_space(records[r]), projected[r], 1e-8, SPOT);
+		assert_approx_equal(first[r], projected[r][0], 1e-8, SPOT);
+	}
+}
+
+void test_kernel_pca::test_num_retained() {
+	const long nvar = 2;
+	stats::fkernel_pca pca(nvar);
+	pca.set_num_landmarks(20);
+	for (const auto& record : make_records(50, nvar))
+		pca.add_record(vector<float>(record.begin(), record.end()));
+	pca.solve();
+	assert_equal(pca.get_num_components(), pca.get_num_retained(), SPOT);
+	pca.set_num_retained(2);
+	assert_equal(2, long(pca.to_principal_space(vector<float>{0.5, -0.5}).size()), SPOT);
+	assert_throw<std::range_error>([&pca]() { pca.set_num_retained(0); }, SPOT);
+	assert_throw<std::range_error>([&pca]() { pca.set_num_retained(pca.get_num_components() + 1); }, SPOT);
+	assert_throw<std::range_error>([&pca]() { pca.get_principal(-1); }, SPOT);
+}
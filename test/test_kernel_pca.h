@@ -0,0 +1,25 @@
+#pragma once
+/**
+ * @file test_kernel_pca.h
+ * @brief Unit tests for the class template stats::basic_kernel_pca
+ */
+#include "kernel_pca.h"
+#include "utils.hpp"
+
+
+struct test_kernel_pca : utils::mytestcase {
+
+	static void run() {
+		RUN(test_kernel_pca, test_setters_throw)
+		RUN(test_kernel_pca, test_solve_throws)
+		RUN(test_kernel_pca, test_linear_kernel_same_as_pca)
+		RUN(test_kernel_pca, test_batch_projection)
+		RUN(test_kernel_pca, test_num_retained)
+	}
+
+	void test_setters_throw();
+	void test_solve_throws();
+	void test_linear_kernel_same_as_pca();
+	void test_batch_projection();
+	void test_num_retained();
+};
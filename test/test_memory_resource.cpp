@@ -0,0 +1,86 @@
+/**
+ * @file test_memory_resource.cpp
+ * @brief Unit tests for the memory resources
+ */
+#include "test_memory_resource.h"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+using namespace std;
+
+namespace {
+
+struct counting_resource : stats::memory_resource {
+	long num_blocks = 0;
+	void* do_allocate(std::size_t bytes, std::size_t alignment) {
+		++num_blocks;
+		return stats::memory_resource::get_default()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* memory, std::size_t bytes, std::size_t alignment) {
+		--num_blocks;
+		stats::memory_resource::get_default()->deallocate(memory, bytes, alignment);
+	}
+};
+
+}
+
+void test_memory_resource::test_default_resource() {
+	auto resource = stats::memory_resource::get_default();
+	assert_equal(resource.get(), stats::memory_resource::get_default().get(), SPOT);
+	void* memory = resource->allocate(1000, 256);
+	assert_equal(0L, long(reinterpret_cast<std::uintptr_t>(memory) % 256), SPOT);
+	std::memset(memory, 1, 1000);
+	resource->deallocate(memory, 1000, 256);
+	assert_true(resource->is_equal(*stats::memory_resource::get_default()), SPOT);
+	stats::arena_resource arena;
+	assert_false(resource->is_equal(arena), SPOT);
+}
+
+void test_memory_resource::test_arena_resource() {
+	auto upstream = std::make_shared<counting_resource>();
+	{
+		stats::arena_resource arena(4096, upstream);
+		void* first = arena.allocate(100);
+		void* second = arena.allocate(100, 128);
+		assert_equal(0L, long(reinterpret_cast<std::uintptr_t>(first) % stats::memory_block_alignment), SPOT);
+		assert_equal(0L, long(reinterpret_cast<std::uintptr_t>(second) % 128), SPOT);
+		assert_true(static_cast<char*>(second) >= static_cast<char*>(first) + 100, SPOT);
+		assert_equal(1L, upstream->num_blocks, SPOT);
+		arena.deallocate(first, 100);
+		void* large = arena.allocate(10000);
+		std::memset(large, 1, 10000);
+		assert_equal(2L, upstream->num_blocks, SPOT);
+		assert_equal(10200L, long(arena.get_bytes_allocated()), SPOT);
+		assert_true(arena.get_bytes_reserved() >= 10000 + 4096, SPOT);
+		arena.release();
+		assert_equal(0L, upstream->num_blocks, SPOT);
+		assert_equal(0L, long(arena.get_bytes_allocated()), SPOT);
+		arena.allocate(10);
+		assert_equal(1L, upstream->num_blocks, SPOT);
+	}
+	assert_equal(0L, upstream->num_blocks, SPOT);
+}
+
+void test_memory_resource::test_memory_block() {
+	auto resource = std::make_shared<counting_resource>();
+	{
+		stats::memory_block block(resource, 64);
+		assert_true(block.get()!=nullptr, SPOT);
+		assert_equal(64L, long(block.size()), SPOT);
+		const stats::memory_block copy = block;
+		assert_true(copy.get()==nullptr, SPOT);
+		stats::memory_block moved = std::move(block);
+		assert_true(block.get()==nullptr, SPOT);
+		assert_equal(1L, resource->num_blocks, SPOT);
+		stats::memory_block other(resource, 32);
+		void* memory = other.get();
+		other = moved;
+		assert_equal(memory, other.get(), SPOT);
+		other = std::move(moved);
+		assert_equal(1L, resource->num_blocks, SPOT);
+		other.reset();
+		assert_equal(0L, resource->num_blocks, SPOT);
+	}
+	assert_equal(0L, resource->num_blocks, SPOT);
+}
@@ -0,0 +1,21 @@
+#pragma once
+/**
+ * @file test_memory_resource.h
+ * @brief Unit tests for the memory resources
+ */
+#include "memory_resource.h"
+#include "utils.hpp"
+
+
+struct test_memory_resource : utils::mytestcase {
+
+	static void run() {
+		RUN(test_memory_resource, test_default_resource)
+		RUN(test_memory_resource, test_arena_resource)
+		RUN(test_memory_resource, test_memory_block)
+	}
+
+	void test_default_resource();
+	void test_arena_resource();
+	void test_memory_block();
+};
@@ -3,6 +3,13 @@
  * @brief Unit tests for the class stats::pca
  */
 #include "test_pca.h"
+#include <thread>
+#include <future>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <limits>
+#include <cmath>
 
 using namespace std;
 
@@ -78,7 +85,7 @@ void test_pca::test_add_record() {
 
 	std::vector<double> record4 = {4, 8, 7};
 
-	assert_throw<std::domain_error>(std::bind(&stats::pca::add_record, pca, record4), SPOT);
+	assert_throw<std::domain_error>([&pca, &record4]() { pca.add_record(record4); }, SPOT);
 }
 
 void test_pca::test_set_do_normalize() {
@@ -114,6 +121,24 @@ void test_pca::test_set_solver() {
 	exp = "dc";
 	pca.set_solver(exp);
 	assert_equal(exp, pca.get_solver(), SPOT);
+	exp = "mixed";
+	pca.set_solver(exp);
+	assert_equal(exp, pca.get_solver(), SPOT);
+	exp = "em";
+	pca.set_solver(exp);
+	assert_equal(exp, pca.get_solver(), SPOT);
+	exp = "tsqr";
+	pca.set_solver(exp);
+	assert_equal(exp, pca.get_solver(), SPOT);
+	exp = "svd";
+	pca.set_solver(exp);
+	assert_equal(exp, pca.get_solver(), SPOT);
+	exp = "packed";
+	pca.set_solver(exp);
+	assert_equal(exp, pca.get_solver(), SPOT);
+	exp = "auto";
+	pca.set_solver(exp);
+	assert_equal(exp, pca.get_solver(), SPOT);
 	std::string solver = "java_sucks";
 	assert_throw<std::logic_error>(std::bind(&stats::pca::set_solver, pca, solver), SPOT);
 }
@@ -286,3 +311,864 @@ void test_pca::test_projections_to_space() {
 	const auto rec3 = pca.to_variable_space(prin3);
 	assert_approx_equal_containers(record3, rec3, utils::feps, SPOT);
 }
+
+void test_pca::test_single_precision() {
+	const int nvar = 4;
+	stats::pca pca(nvar);
+	add_records(pca);
+	pca.solve();
+
+	stats::fpca fpca(nvar);
+	fpca.add_record({1, 2.5, 42, 7});
+	fpca.add_record({3, 4.2, 90, 7});
+	fpca.add_record({456, 444, 0, 7});
+	fpca.solve();
+
+	const float eps = 1e-4;
+	const auto eigval = pca.get_eigenvalues();
+	const auto feigval = fpca.get_eigenvalues();
+	assert_approx_equal_containers(eigval, feigval, eps, SPOT);
+
+	const auto eigvec = pca.get_eigenvector(0);
+	const auto feigvec = fpca.get_eigenvector(0);
+	assert_approx_equal_containers(eigvec, feigvec, eps, SPOT);
+
+	const auto record = fpca.get_record(1);
+	const auto rec = fpca.to_variable_space(fpca.to_principal_space(record));
+	assert_approx_equal_containers(record, rec, eps*100, SPOT);
+}
+
+void test_pca::test_mixed_precision_solver() {
+	const int nvar = 12;
+	stats::pca pca_dc(nvar);
+	stats::pca pca_mixed(nvar);
+	pca_mixed.set_solver("mixed");
+	for (int i=0; i<200; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (rand()%1000) * (j+1) / 10.;
+		pca_dc.add_record(record);
+		pca_mixed.add_record(record);
+	}
+	pca_dc.solve();
+	pca_mixed.solve();
+
+	const double eps = 1e-9;
+	assert_approx_equal(pca_dc.get_energy(), pca_mixed.get_energy(), pca_dc.get_energy()*eps, SPOT);
+	assert_approx_equal_containers(pca_dc.get_eigenvalues(), pca_mixed.get_eigenvalues(), eps, SPOT);
+	for (int i=0; i<nvar; ++i)
+		assert_approx_equal_containers(pca_dc.get_eigenvector(i), pca_mixed.get_eigenvector(i), 1e-7, SPOT);
+}
+
+void test_pca::test_em_solver() {
+	const int nvar = 30;
+	const int ncomp = 3;
+	std::mt19937 generator(11);
+	std::normal_distribution<double> normal;
+	stats::pca pca_dc(nvar);
+	stats::pca pca_em(nvar);
+	pca_em.set_solver("em");
+	pca_em.set_num_retained(ncomp);
+	pca_em.set_em_iterations(5000, 1e-13);
+	assert_throw<std::invalid_argument>([&pca_em]() { pca_em.set_em_iterations(0); }, SPOT);
+	assert_throw<std::invalid_argument>([&pca_em]() { pca_em.set_em_iterations(10, -1); }, SPOT);
+	for (int i=0; i<500; ++i) {
+		const double factors[ncomp] = {8 * normal(generator), 4 * normal(generator), 2 * normal(generator)};
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = factors[j % ncomp] * (1 + j % 4) + 0.5 * normal(generator);
+		pca_dc.add_record(record);
+		pca_em.add_record(record);
+	}
+	pca_dc.solve();
+	pca_em.solve();
+	pca_dc.set_num_retained(ncomp);
+
+	const double eps = 1e-7;
+	assert_equal(ncomp, long(pca_em.get_eigenvalues().size()), SPOT);
+	assert_throw<std::range_error>([&pca_em]() { pca_em.get_eigenvalue(ncomp); }, SPOT);
+	assert_approx_equal(pca_dc.get_energy(), pca_em.get_energy(), pca_dc.get_energy()*eps, SPOT);
+	assert_approx_equal(pca_dc.get_noise_variance(), pca_em.get_noise_variance(), eps, SPOT);
+	assert_approx_equal(1., pca_em.check_eigenvectors_orthogonal(), eps, SPOT);
+	for (int i=0; i<ncomp; ++i) {
+		assert_approx_equal(pca_dc.get_eigenvalue(i), pca_em.get_eigenvalue(i), eps, SPOT);
+		assert_approx_equal_containers(pca_dc.get_eigenvector(i), pca_em.get_eigenvector(i), 1e-6, SPOT);
+	}
+	const auto record = pca_em.get_record(0);
+	assert_approx_equal_containers(pca_dc.to_principal_space(record), pca_em.to_principal_space(record), 1e-5, SPOT);
+
+	pca_em.set_do_bootstrap(true, 10);
+	pca_em.set_em_iterations(200, 1e-8);
+	pca_em.solve();
+	assert_equal(10, long(pca_em.get_eigenvalue_boot(ncomp - 1).size()), SPOT);
+	assert_throw<std::range_error>([&pca_em]() { pca_em.get_eigenvalue_boot(ncomp); }, SPOT);
+}
+
+void test_pca::test_tsqr_solver() {
+	const int nvar = 8;
+	std::mt19937 generator(17);
+	std::normal_distribution<double> normal;
+	stats::pca pca_dc(nvar);
+	stats::pca pca_tsqr(nvar);
+	pca_tsqr.set_solver("tsqr");
+	pca_tsqr.set_num_threads(1);
+	// three blocks of records reduced in an unbalanced tree
+	for (int i=0; i<10000; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (j + 1) * normal(generator) + (j==0 ? 0 : 0.5 * record[j - 1]);
+		pca_dc.add_record(record);
+		pca_tsqr.add_record(record);
+	}
+	stats::pca pca_threads = pca_tsqr;
+	pca_threads.set_num_threads(3);
+	pca_dc.solve();
+	pca_tsqr.solve();
+	pca_threads.solve();
+
+	const double eps = 1e-10;
+	assert_approx_equal(pca_dc.get_energy(), pca_tsqr.get_energy(), pca_dc.get_energy()*eps, SPOT);
+	assert_approx_equal_containers(pca_dc.get_eigenvalues(), pca_tsqr.get_eigenvalues(), eps, SPOT);
+	for (int i=0; i<nvar; ++i)
+		assert_approx_equal_containers(pca_dc.get_eigenvector(i), pca_tsqr.get_eigenvector(i), 1e-8, SPOT);
+	assert_approx_equal(1., pca_tsqr.check_eigenvectors_orthogonal(), eps, SPOT);
+	assert_approx_equal(1., pca_tsqr.check_projection_accurate(), eps, SPOT);
+	assert_true(pca_tsqr==pca_threads, SPOT);
+
+	// fewer records than variables
+	stats::pca pca_wide(nvar);
+	pca_wide.set_solver("tsqr");
+	for (int i=0; i<5; ++i)
+		pca_wide.add_record(pca_dc.get_record(i));
+	pca_wide.set_do_bootstrap(true, 10);
+	pca_wide.solve();
+	assert_equal(5, long(pca_wide.get_eigenvalues().size()), SPOT);
+	assert_equal(10, long(pca_wide.get_eigenvalue_boot(4).size()), SPOT);
+}
+
+void test_pca::test_svd_solver() {
+	const int nvar = 6;
+	std::mt19937 generator(23);
+	std::normal_distribution<double> normal;
+	stats::pca pca_dc(nvar);
+	stats::pca pca_svd(nvar);
+	pca_svd.set_solver("svd");
+	for (int i=0; i<300; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (nvar - j) * normal(generator) + (j==0 ? 0 : record[j - 1]);
+		pca_dc.add_record(record);
+		pca_svd.add_record(record, 1 + i % 3);
+	}
+	pca_dc.set_do_normalize(true);
+	pca_svd.set_do_normalize(true);
+	stats::pca pca_weighted = pca_svd;
+	pca_weighted.set_solver("dc");
+	stats::pca pca_plain(nvar);
+	pca_plain.set_solver("svd");
+	pca_plain.set_do_normalize(true);
+	for (int i=0; i<300; ++i)
+		pca_plain.add_record(pca_dc.get_record(i));
+	pca_dc.solve();
+	pca_plain.solve();
+	pca_svd.solve();
+	pca_weighted.solve();
+
+	const double eps = 1e-10;
+	assert_approx_equal(pca_dc.get_energy(), pca_plain.get_energy(), pca_dc.get_energy()*eps, SPOT);
+	assert_approx_equal_containers(pca_dc.get_eigenvalues(), pca_plain.get_eigenvalues(), eps, SPOT);
+	assert_approx_equal_containers(pca_weighted.get_eigenvalues(), pca_svd.get_eigenvalues(), eps, SPOT);
+	for (int i=0; i<nvar; ++i) {
+		assert_approx_equal_containers(pca_dc.get_eigenvector(i), pca_plain.get_eigenvector(i), 1e-8, SPOT);
+		assert_approx_equal_containers(pca_dc.get_principal(i), pca_plain.get_principal(i), 1e-8, SPOT);
+		assert_approx_equal_containers(pca_weighted.get_eigenvector(i), pca_svd.get_eigenvector(i), 1e-8, SPOT);
+		assert_approx_equal_containers(pca_weighted.get_principal(i), pca_svd.get_principal(i), 1e-8, SPOT);
+	}
+	assert_approx_equal(1., pca_plain.check_projection_accurate(), eps, SPOT);
+
+	pca_plain.set_do_bootstrap(true, 10);
+	pca_plain.solve();
+	assert_equal(10, long(pca_plain.get_energy_boot().size()), SPOT);
+}
+
+void test_pca::test_packed_solver() {
+	const int nvar = 7;
+	std::mt19937 generator(31);
+	std::normal_distribution<double> normal;
+	stats::pca pca_dc(nvar);
+	stats::pca pca_packed(nvar);
+	pca_packed.set_solver("packed");
+	for (int i=0; i<500; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (j + 1) * normal(generator) + (j==0 ? 0 : record[j - 1]);
+		pca_dc.add_record(record);
+		pca_packed.add_record(record);
+	}
+	pca_dc.set_do_bootstrap(true, 10);
+	pca_packed.set_do_bootstrap(true, 10);
+	pca_dc.solve();
+	pca_packed.solve();
+	const double eps = 1e-9;
+	assert_approx_equal(pca_dc.get_energy(), pca_packed.get_energy(), pca_dc.get_energy()*eps, SPOT);
+	assert_approx_equal_containers(pca_dc.get_eigenvalues(), pca_packed.get_eigenvalues(), eps, SPOT);
+	for (int i=0; i<nvar; ++i) {
+		assert_approx_equal_containers(pca_dc.get_eigenvector(i), pca_packed.get_eigenvector(i), 1e-8, SPOT);
+		assert_approx_equal_containers(pca_dc.get_eigenvalue_boot(i), pca_packed.get_eigenvalue_boot(i), eps, SPOT);
+	}
+	assert_approx_equal(1., pca_packed.check_projection_accurate(), eps, SPOT);
+	assert_equal("packed", pca_packed.get_chosen_solver(), SPOT);
+}
+
+void test_pca::test_auto_solver() {
+	const int nvar = 10;
+	stats::pca pca_dc(nvar);
+	stats::pca pca_auto(nvar);
+	pca_auto.set_solver("auto");
+	assert_equal("", pca_auto.get_chosen_solver(), SPOT);
+	std::mt19937 generator(29);
+	std::normal_distribution<double> normal;
+	for (int i=0; i<2000; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (j + 1) * normal(generator) + (j==0 ? 0 : record[j - 1]);
+		pca_dc.add_record(record);
+		pca_auto.add_record(record);
+	}
+	pca_dc.solve();
+	pca_auto.solve();
+	assert_equal("dc", pca_dc.get_chosen_solver(), SPOT);
+	assert_equal("auto", pca_auto.get_solver(), SPOT);
+	const std::string chosen = pca_auto.get_chosen_solver();
+	assert_equal(stats::utils::choose_solver(2000, nvar, pca_auto.get_num_threads()), chosen, SPOT);
+	assert_true(chosen!="auto" && chosen!="em" && chosen!="mixed", SPOT);
+	assert_approx_equal(pca_dc.get_energy(), pca_auto.get_energy(), pca_dc.get_energy()*1e-6, SPOT);
+	assert_approx_equal_containers(pca_dc.get_eigenvalues(), pca_auto.get_eigenvalues(), 1e-6, SPOT);
+
+	// few retained components of many variables still yield all eigenpairs
+	stats::pca pca_wide(60);
+	pca_wide.set_solver("auto");
+	pca_wide.set_num_retained(1);
+	for (int i=0; i<30; ++i) {
+		std::vector<double> record(60);
+		const double factor = 10 * normal(generator);
+		for (int j=0; j<60; ++j)
+			record[j] = factor + normal(generator);
+		pca_wide.add_record(record);
+	}
+	pca_wide.solve();
+	assert_true(pca_wide.get_chosen_solver()=="dc" || pca_wide.get_chosen_solver()=="packed", SPOT);
+	assert_equal(60, long(pca_wide.get_eigenvalues().size()), SPOT);
+}
+
+void test_pca::test_missing_values() {
+	const int nvar = 12;
+	const int ncomp = 3;
+	const double nan = std::numeric_limits<double>::quiet_NaN();
+	std::mt19937 generator(5);
+	std::normal_distribution<double> normal;
+	std::uniform_real_distribution<double> uniform;
+	stats::pca pca_full(nvar);
+	stats::pca pca_missing(nvar);
+	stats::pca pca_concurrent(nvar);
+	pca_concurrent.set_do_concurrent_ingestion(true);
+	pca_missing.set_num_retained(ncomp);
+	pca_missing.set_em_iterations(1000, 1e-10);
+	std::vector<double> sums(nvar, 0.);
+	std::vector<long> counts(nvar, 0);
+	long num_missing = 0;
+	for (int i=0; i<400; ++i) {
+		const double factors[ncomp] = {6 * normal(generator), 3 * normal(generator), 1.5 * normal(generator)};
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = 10 + j + factors[j % ncomp] * (1 + j % 4) + 0.01 * normal(generator);
+		pca_full.add_record(record);
+		for (int j=0; j<nvar; ++j) {
+			if (uniform(generator) < 0.05) {
+				record[j] = nan;
+				++num_missing;
+			} else {
+				sums[j] += record[j];
+				++counts[j];
+			}
+		}
+		pca_missing.add_record(record);
+		pca_concurrent.add_record(record);
+	}
+	assert_equal(num_missing, pca_missing.get_num_missing(), SPOT);
+	// records added concurrently are marked when they are flushed
+	assert_equal(0, pca_concurrent.get_num_missing(), SPOT);
+	pca_concurrent.flush_records();
+	assert_equal(num_missing, pca_concurrent.get_num_missing(), SPOT);
+	assert_equal(0, pca_full.get_num_missing(), SPOT);
+	assert_false(pca_full.is_missing(3, 4), SPOT);
+	assert_throw<std::range_error>([&pca_missing]() { pca_missing.is_missing(400, 0); }, SPOT);
+	assert_throw<std::range_error>([&pca_missing]() { pca_missing.is_missing(0, nvar); }, SPOT);
+	long num_marked = 0;
+	for (int i=0; i<400; ++i) {
+		const auto record = pca_missing.get_record(i);
+		for (int j=0; j<nvar; ++j) {
+			assert_equal(bool(std::isnan(record[j])), pca_missing.is_missing(i, j), SPOT);
+			assert_equal(pca_missing.is_missing(i, j), pca_concurrent.is_missing(i, j), SPOT);
+			num_marked += pca_missing.is_missing(i, j);
+		}
+	}
+	assert_equal(num_missing, num_marked, SPOT);
+
+	pca_full.solve();
+	pca_missing.solve();
+	const auto means = pca_missing.get_mean_values();
+	for (int j=0; j<nvar; ++j)
+		assert_approx_equal(sums[j] / counts[j], means[j], 1e-10, SPOT);
+	assert_approx_equal(1., pca_missing.check_eigenvectors_orthogonal(), 1e-10, SPOT);
+	// the imputed data are close to rank three so the components are recovered
+	for (int i=0; i<ncomp; ++i) {
+		assert_approx_equal(pca_full.get_eigenvalue(i), pca_missing.get_eigenvalue(i), 1e-2, SPOT);
+		assert_approx_equal_containers(pca_full.get_eigenvector(i), pca_missing.get_eigenvector(i), 1e-2, SPOT);
+	}
+
+	stats::pca pca_unobserved(3);
+	for (int i=0; i<10; ++i)
+		pca_unobserved.add_record({double(i), nan, double(i * i)});
+	assert_equal(10, pca_unobserved.get_num_missing(), SPOT);
+	assert_throw<std::runtime_error>([&pca_unobserved]() { pca_unobserved.solve(); }, SPOT);
+}
+
+void test_pca::test_weighted_records() {
+	const int nvar = 5;
+	std::mt19937 generator(3);
+	std::normal_distribution<double> normal;
+	stats::pca pca_copies(nvar);
+	stats::pca pca_weighted(nvar);
+	stats::pca pca_concurrent(nvar);
+	pca_concurrent.set_do_concurrent_ingestion(true);
+	assert_throw<std::invalid_argument>([&pca_weighted]() { pca_weighted.add_record(std::vector<double>(nvar, 1.), 0); }, SPOT);
+	assert_throw<std::invalid_argument>([&pca_weighted]() { pca_weighted.add_record(std::vector<double>(nvar, 1.), -2); }, SPOT);
+	long num_copies = 0;
+	for (int i=0; i<60; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (j + 1) * normal(generator) + (j==0 ? 0 : record[j - 1]);
+		// the first records have unit weights
+		const int weight = i<10 ? 1 : 1 + i % 4;
+		for (int k=0; k<weight; ++k)
+			pca_copies.add_record(record);
+		pca_weighted.add_record(record, weight);
+		pca_concurrent.add_record(record, weight);
+		num_copies += weight;
+	}
+	assert_equal(60, pca_weighted.get_num_records(), SPOT);
+	assert_approx_equal(double(num_copies), pca_weighted.get_total_weight(), 1e-12, SPOT);
+	assert_approx_equal(double(pca_copies.get_num_records()), pca_copies.get_total_weight(), 1e-12, SPOT);
+	pca_concurrent.flush_records();
+	assert_approx_equal(double(num_copies), pca_concurrent.get_total_weight(), 1e-12, SPOT);
+
+	pca_copies.solve();
+	pca_weighted.solve();
+	pca_concurrent.solve();
+	const double eps = 1e-9;
+	assert_approx_equal_containers(pca_copies.get_mean_values(), pca_weighted.get_mean_values(), eps, SPOT);
+	assert_approx_equal_containers(pca_copies.get_sigma_values(), pca_weighted.get_sigma_values(), eps, SPOT);
+	assert_approx_equal(pca_copies.get_energy(), pca_weighted.get_energy(), pca_copies.get_energy()*eps, SPOT);
+	assert_approx_equal_containers(pca_copies.get_eigenvalues(), pca_weighted.get_eigenvalues(), eps, SPOT);
+	for (int i=0; i<nvar; ++i)
+		assert_approx_equal_containers(pca_copies.get_eigenvector(i), pca_weighted.get_eigenvector(i), 1e-7, SPOT);
+	assert_approx_equal(1., pca_weighted.check_projection_accurate(), eps, SPOT);
+	assert_approx_equal_containers(pca_weighted.get_eigenvalues(), pca_concurrent.get_eigenvalues(), eps, SPOT);
+	// the principal components have one value per record and not per copy
+	const auto principal = pca_weighted.get_principal(0);
+	assert_equal(60, long(principal.size()), SPOT);
+	assert_approx_equal(pca_copies.get_principal(0)[0], principal[0], 1e-7, SPOT);
+	assert_approx_equal(pca_copies.get_principal(0)[num_copies - 1], principal[59], 1e-7, SPOT);
+
+	pca_weighted.set_do_bootstrap(true, 10);
+	pca_weighted.solve();
+	const auto energy_boot = pca_weighted.get_energy_boot();
+	const double energy_mean = std::accumulate(energy_boot.begin(), energy_boot.end(), 0.) / energy_boot.size();
+	assert_approx_equal(pca_weighted.get_energy(), energy_mean, 0.5 * pca_weighted.get_energy(), SPOT);
+
+	// a cancelled solve leaves the records unscaled
+	stats::pca pca_cancelled(3);
+	stats::pca pca_reference(3);
+	for (int i=0; i<40; ++i) {
+		const std::vector<double> record = {double(i), double(i % 7), double(i * i % 5)};
+		pca_cancelled.add_record(record, 1 + i % 4);
+		pca_reference.add_record(record, 1 + i % 4);
+	}
+	stats::cancellation_token token;
+	pca_cancelled.set_cancellation_token(token);
+	pca_cancelled.set_progress_callback([&token](const std::string& stage, double, long) {
+		if (stage=="eigensolve") token.cancel();
+	});
+	assert_throw<stats::solve_cancelled>([&pca_cancelled]() { pca_cancelled.solve(); }, SPOT);
+	token.reset();
+	pca_cancelled.set_progress_callback(stats::progress_callback());
+	pca_cancelled.solve();
+	pca_reference.solve();
+	assert_approx_equal_containers(pca_reference.get_eigenvalues(), pca_cancelled.get_eigenvalues(), 1e-10, SPOT);
+	assert_approx_equal_containers(pca_reference.get_sigma_values(), pca_cancelled.get_sigma_values(), 1e-10, SPOT);
+
+	// weights keep double precision with concurrent ingestion into a float pca
+	stats::fpca fpca_direct(3);
+	stats::fpca fpca_concurrent(3);
+	fpca_concurrent.set_do_concurrent_ingestion(true);
+	for (int i=0; i<40; ++i) {
+		const std::vector<float> record = {float(i), float(i % 7), float(i * i % 5)};
+		const double weight = i==0 ? 1e-50 : 1.1 + i % 3;
+		fpca_direct.add_record(record, weight);
+		fpca_concurrent.add_record(record, weight);
+	}
+	fpca_direct.solve();
+	fpca_concurrent.solve();
+	assert_equal(fpca_direct.get_total_weight(), fpca_concurrent.get_total_weight(), SPOT);
+	assert_equal_containers(fpca_direct.get_eigenvalues(), fpca_concurrent.get_eigenvalues(), SPOT);
+	const auto fprincipal = fpca_concurrent.get_principal(0);
+	assert_true(std::all_of(fprincipal.begin(), fprincipal.end(), [](float value) { return std::isfinite(value); }), SPOT);
+}
+
+void test_pca::test_thread_pool() {
+	const int nvar = 6;
+	stats::pca pca_single(nvar);
+	pca_single.set_num_threads(1);
+	pca_single.set_do_bootstrap(true, 20, 3);
+	for (int i=0; i<100; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (rand()%1000) * (j+1) / 10.;
+		pca_single.add_record(record);
+	}
+	stats::pca pca_multi = pca_single;
+	pca_multi.set_num_threads(4);
+	assert_equal(1, pca_single.get_num_threads(), SPOT);
+	assert_equal(4, pca_multi.get_num_threads(), SPOT);
+	assert_throw<std::invalid_argument>(std::bind(&stats::pca::set_num_threads, &pca_multi, 0), SPOT);
+
+	pca_single.solve();
+	pca_multi.solve();
+	assert_true(pca_single==pca_multi, SPOT);
+
+	auto pool = std::make_shared<stats::thread_pool>(2);
+	pca_multi.set_thread_pool(pool);
+	assert_equal(pool.get(), pca_multi.get_thread_pool().get(), SPOT);
+	pca_multi.set_thread_pool(std::shared_ptr<stats::thread_pool>());
+	assert_equal(stats::thread_pool::get_default().get(), pca_multi.get_thread_pool().get(), SPOT);
+}
+
+void test_pca::test_memory_placement() {
+	const int nvar = 5;
+	stats::pca pca_default(nvar);
+	pca_default.set_do_bootstrap(true, 10);
+	assert_equal("default", pca_default.get_memory_placement(), SPOT);
+	assert_false(pca_default.get_use_huge_pages(), SPOT);
+	stats::pca pca_first_touch = pca_default;
+	pca_first_touch.set_num_threads(3);
+	pca_first_touch.set_memory_placement("first_touch", true);
+	assert_equal("first_touch", pca_first_touch.get_memory_placement(), SPOT);
+	assert_true(pca_first_touch.get_use_huge_pages(), SPOT);
+	stats::pca pca_interleave;
+	pca_interleave.set_memory_placement("interleave");
+	pca_interleave.set_num_variables(nvar);
+	pca_interleave.set_do_bootstrap(true, 10);
+	assert_throw<std::invalid_argument>([&]() { pca_interleave.set_memory_placement("nowhere"); }, SPOT);
+	for (int i=0; i<2500; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (i * (j + 2) % 31) + j * 0.5 + (j==0 ? 0 : record[j - 1]);
+		pca_default.add_record(record);
+		pca_first_touch.add_record(record);
+		pca_interleave.add_record(record);
+	}
+	assert_equal_containers(pca_default.get_record(2499), pca_first_touch.get_record(2499), SPOT);
+	pca_default.solve();
+	pca_first_touch.solve();
+	pca_interleave.solve();
+	assert_true(pca_default==pca_first_touch, SPOT);
+	assert_true(pca_default==pca_interleave, SPOT);
+}
+
+void test_pca::test_memory_resource() {
+	const int nvar = 4;
+	auto arena = std::make_shared<stats::arena_resource>(1 << 16);
+	stats::pca pca_heap(nvar);
+	stats::pca pca_arena(nvar);
+	assert_true(pca_arena.get_memory_resource()==nullptr, SPOT);
+	pca_arena.set_memory_resource(arena);
+	assert_equal(arena.get(), pca_arena.get_memory_resource().get(), SPOT);
+	const std::size_t initial = arena->get_bytes_allocated();
+	assert_true(initial >= 1000 * nvar * sizeof(double), SPOT);
+	for (int i=0; i<3000; ++i) {
+		std::vector<double> record(nvar);
+		for (int j=0; j<nvar; ++j)
+			record[j] = (i * (j + 3) % 23) + (j==0 ? 0 : 0.5 * record[j - 1]);
+		pca_heap.add_record(record);
+		pca_arena.add_record(record);
+	}
+	assert_true(arena->get_bytes_allocated() > initial, SPOT);
+	pca_heap.solve();
+	pca_arena.solve();
+	assert_true(pca_heap==pca_arena, SPOT);
+	// the principal components and a newly placed data matrix come from the arena
+	const std::size_t solved = arena->get_bytes_allocated();
+	pca_arena.solve();
+	assert_true(arena->get_bytes_allocated() >= solved + 3000 * nvar * sizeof(double), SPOT);
+	const std::size_t placed = arena->get_bytes_allocated();
+	pca_arena.set_memory_placement("first_touch");
+	assert_true(arena->get_bytes_allocated() >= placed + 3000 * nvar * sizeof(double), SPOT);
+	pca_heap.solve();
+	assert_true(pca_heap==pca_arena, SPOT);
+
+	stats::pca pca_copy = pca_arena;
+	assert_true(pca_copy==pca_arena, SPOT);
+	pca_arena.set_memory_resource(std::shared_ptr<stats::memory_resource>());
+	arena->release();
+	assert_true(pca_heap==pca_arena, SPOT);
+	assert_true(pca_heap==pca_copy, SPOT);
+	assert_equal_containers(pca_heap.get_record(2999), pca_arena.get_record(2999), SPOT);
+	assert_equal_containers(pca_heap.get_principal(0), pca_arena.get_principal(0), SPOT);
+}
+
+void test_pca::test_views() {
+	const int nvar = 4;
+	stats::pca pca(nvar);
+	add_records(pca);
+	pca.add_record({2, 5.5, 11, 8});
+	const stats::vector_view<double> record = pca.view_record(1);
+	assert_equal(nvar, record.size(), SPOT);
+	assert_equal_containers(pca.get_record(1), record.to_vector(), SPOT);
+	assert_equal(4.2, record[1], SPOT);
+	pca.set_do_bootstrap(true, 10);
+	pca.solve();
+	for (long i=0; i<nvar; ++i) {
+		assert_equal_containers(pca.get_eigenvector(i), pca.view_eigenvector(i).to_vector(), SPOT);
+		assert_equal_containers(pca.get_principal(i), pca.view_principal(i).to_vector(), SPOT);
+		assert_equal_containers(pca.get_eigenvalue_boot(i), pca.view_eigenvalue_boot(i).to_vector(), SPOT);
+	}
+	assert_equal(4L, pca.view_principal(0).size(), SPOT);
+	assert_equal_containers(pca.get_eigenvalues(), pca.view_eigenvalues().to_vector(), SPOT);
+	assert_equal_containers(pca.get_energy_boot(), pca.view_energy_boot().to_vector(), SPOT);
+	assert_equal_containers(pca.get_mean_values(), pca.view_mean_values().to_vector(), SPOT);
+	assert_equal_containers(pca.get_sigma_values(), pca.view_sigma_values().to_vector(), SPOT);
+	assert_throw<std::range_error>([&]() { pca.view_eigenvector(nvar); }, SPOT);
+	assert_throw<std::range_error>([&]() { pca.view_principal(-1); }, SPOT);
+	assert_throw<std::range_error>([&]() { pca.view_record(4); }, SPOT);
+}
+
+void test_pca::test_batch_projection() {
+	const int nvar = 4;
+	stats::pca pca(nvar);
+	add_records(pca);
+	pca.solve();
+	pca.set_num_threads(3);
+
+	std::vector<std::vector<double>> records;
+	for (int i=0; i<600; ++i)
+		records.push_back({double(i), i * 0.5, 42. - i, 7.});
+	const auto projected = pca.to_principal_space(records);
+	assert_equal(records.size(), projected.size(), SPOT);
+	const double eps = 1e-6;
+	for (size_t i=0; i<records.size(); i+=97)
+		assert_approx_equal_containers(pca.to_principal_space(records[i]), projected[i], eps, SPOT);
+
+	records[300].pop_back();
+	assert_throw<std::domain_error>([&pca, &records]() { pca.to_principal_space(records); }, SPOT);
+}
+
+void test_pca::test_concurrent_ingestion() {
+	const int nvar = 3;
+	const int num_threads = 4;
+	const int num_per_thread = 700;
+	stats::pca pca(nvar);
+	pca.set_do_concurrent_ingestion(true);
+	assert_true(pca.get_do_concurrent_ingestion(), SPOT);
+
+	std::vector<std::thread> producers;
+	for (int t=0; t<num_threads; ++t) {
+		producers.emplace_back([&pca, t]() {
+			for (int i=0; i<num_per_thread; ++i)
+				pca.add_record({double(t), double(i), double(t * i % 11)});
+		});
+	}
+	for (auto& producer : producers)
+		producer.join();
+	assert_equal(0, pca.get_num_records(), SPOT);
+
+	pca.flush_records();
+	assert_equal(num_threads * num_per_thread, pca.get_num_records(), SPOT);
+	std::vector<int> last(num_threads, -1);
+	for (int r=0; r<pca.get_num_records(); ++r) {
+		const auto record = pca.get_record(r);
+		const int t = record[0];
+		assert_equal(last[t] + 1, int(record[1]), SPOT);
+		assert_equal(double(t * (last[t] + 1) % 11), record[2], SPOT);
+		last[t] = record[1];
+	}
+
+	pca.add_record({1., 2., 3.});
+	pca.set_do_concurrent_ingestion(false);
+	assert_equal(num_threads * num_per_thread + 1, pca.get_num_records(), SPOT);
+	pca.add_record({4., 5., 6.});
+	assert_equal(num_threads * num_per_thread + 2, pca.get_num_records(), SPOT);
+	assert_no_throw([&pca]() { pca.solve(); }, SPOT);
+}
+
+void test_pca::test_ingestion_after_solve() {
+	const int nvar = 3;
+	stats::pca pca(nvar);
+	for (int i=0; i<20; ++i)
+		pca.add_record({double(i), double(i % 7), double(i * i % 5)});
+	pca.solve();
+	pca.set_do_concurrent_ingestion(true);
+	std::vector<std::thread> producers;
+	for (int t=0; t<2; ++t) {
+		producers.emplace_back([&pca, t]() {
+			for (int i=0; i<30; ++i)
+				pca.add_record({double(t + i), double(i % 3), double(t * i % 11)});
+		});
+	}
+	for (auto& producer : producers)
+		producer.join();
+	assert_no_throw([&pca]() { pca.flush_records(); }, SPOT);
+	assert_equal(80, pca.get_num_records(), SPOT);
+	assert_no_throw([&pca]() { pca.solve(); }, SPOT);
+	pca.set_do_concurrent_ingestion(false);
+	pca.add_record({1., 2., 3.});
+	assert_equal_containers(std::vector<double>({1., 2., 3.}), pca.get_record(80), SPOT);
+	assert_no_throw([&pca]() { pca.solve(); }, SPOT);
+	assert_equal_containers(std::vector<double>({0., 0., 0.}), pca.get_record(0), SPOT);
+	// a fresh instance solving the same records once gives the same model
+	stats::pca pca_fresh(nvar);
+	for (int i=0; i<81; ++i)
+		pca_fresh.add_record(pca.get_record(i));
+	pca_fresh.solve();
+	const double eps = 1e-10;
+	assert_approx_equal_containers(pca_fresh.get_mean_values(), pca.get_mean_values(), eps, SPOT);
+	assert_approx_equal_containers(pca_fresh.get_eigenvalues(), pca.get_eigenvalues(), eps, SPOT);
+	assert_equal_containers(pca_fresh.get_record(0), pca.get_record(0), SPOT);
+}
+
+void test_pca::test_model_snapshots() {
+	const int nvar = 4;
+	stats::pca pca(nvar);
+	for (int i=0; i<50; ++i)
+		pca.add_record({double(i), i * 2.5 + i % 7, 42. - i % 5, 7. + i % 3});
+	pca.solve();
+
+	const auto model = pca.get_model();
+	const arma::Mat<double> eigvec = model->eigvec;
+	const arma::Col<double> mean = model->mean;
+	assert_equal(nvar, long(model->eigvec.n_cols), SPOT);
+
+	std::atomic<bool> stop(false);
+	std::atomic<long> bad_sizes(0);
+	std::vector<std::thread> readers;
+	for (int t=0; t<3; ++t) {
+		readers.emplace_back([&]() {
+			const std::vector<double> record = {1, 2, 3, 4};
+			while (!stop) {
+				const auto prin = pca.to_principal_space(record);
+				if (prin.size()<2 || prin.size()>size_t(nvar)) ++bad_sizes;
+			}
+		});
+	}
+	for (int i=0; i<20; ++i) {
+		pca.set_do_normalize(i % 2);
+		pca.solve();
+		pca.set_num_retained(2 + i % 3);
+	}
+	stop = true;
+	for (auto& reader : readers)
+		reader.join();
+	assert_equal(0, bad_sizes.load(), SPOT);
+
+	assert_equal_containers(eigvec, model->eigvec, SPOT);
+	assert_equal_containers(mean, model->mean, SPOT);
+	// solving the same records again publishes a new snapshot with the same means
+	assert_false(model==pca.get_model(), SPOT);
+	assert_approx_equal_containers(mean, pca.get_model()->mean, 1e-12, SPOT);
+	assert_equal(pca.get_num_retained(), long(pca.get_model()->eigvec.n_cols), SPOT);
+}
+
+void test_pca::test_solve_async() {
+	const int nvar = 4;
+	stats::pca pca_sync(nvar);
+	add_records(pca_sync);
+	stats::pca pca_async = pca_sync;
+	pca_async.set_num_threads(1);
+	pca_sync.solve();
+
+	const auto model = pca_async.get_model();
+	auto future = pca_async.solve_async();
+	const std::vector<double> record = {1, 2, 3, 4};
+	assert_equal(nvar, long(pca_async.to_principal_space(record).size()), SPOT);
+	future.get();
+	assert_true(pca_sync==pca_async, SPOT);
+	assert_false(model==pca_async.get_model(), SPOT);
+
+	stats::pca pca_empty(nvar);
+	auto failed = pca_empty.solve_async();
+	assert_throw<std::logic_error>([&failed]() { failed.get(); }, SPOT);
+}
+
+void test_pca::test_add_during_solve_async() {
+	const int nvar = 3;
+	stats::pca pca(nvar);
+	pca.set_do_bootstrap(true, 20);
+	for (int i=0; i<200; ++i)
+		pca.add_record({double(i), double(i % 7), double(i * i % 5)});
+	// the records are added once the async solve has taken the pending ones
+	std::promise<void> solving;
+	std::promise<void> added;
+	std::shared_future<void> added_future = added.get_future().share();
+	pca.set_progress_callback([&](const std::string& stage, double, long) {
+		if (stage=="statistics") {
+			solving.set_value();
+			added_future.wait();
+		}
+	});
+	pca.set_do_concurrent_ingestion(true);
+	auto future = pca.solve_async();
+	solving.get_future().wait();
+	for (int i=0; i<100; ++i)
+		pca.add_record({double(i % 13), double(i), double(i % 4)});
+	added.set_value();
+	future.get();
+	pca.set_progress_callback(stats::progress_callback());
+	assert_no_throw([&pca]() { pca.solve(); }, SPOT);
+	assert_equal(300, pca.get_num_records(), SPOT);
+	assert_equal_containers(std::vector<double>({0., 0., 0.}), pca.get_record(0), SPOT);
+	assert_equal_containers(std::vector<double>({199., 3., 1.}), pca.get_record(199), SPOT);
+	// a fresh instance solving all records once gives the same model
+	stats::pca pca_fresh(nvar);
+	pca_fresh.set_do_bootstrap(true, 20);
+	for (int i=0; i<200; ++i)
+		pca_fresh.add_record({double(i), double(i % 7), double(i * i % 5)});
+	for (int i=0; i<100; ++i)
+		pca_fresh.add_record({double(i % 13), double(i), double(i % 4)});
+	pca_fresh.solve();
+	assert_true(pca_fresh==pca, SPOT);
+}
+
+void test_pca::test_overlapping_blas_threads() {
+	const int nvar = 4;
+	const long previous = stats::utils::get_blas_num_threads();
+	std::vector<stats::pca> pcas(2, stats::pca(nvar));
+	std::vector<std::promise<void>> solving(2);
+	std::vector<std::promise<void>> released(2);
+	std::vector<std::future<void>> futures;
+	for (int k=0; k<2; ++k) {
+		add_records(pcas[k]);
+		auto pool = std::make_shared<stats::thread_pool>(k + 2);
+		pool->set_blas_num_threads(previous + k + 1);
+		pcas[k].set_thread_pool(pool);
+		std::shared_future<void> release = released[k].get_future().share();
+		pcas[k].set_progress_callback([&solving, release, k](const std::string& stage, double, long) {
+			if (stage=="statistics") {
+				solving[k].set_value();
+				release.wait();
+			}
+		});
+	}
+	// both solves hold their BLAS scope until they are released, the first one ends first
+	for (int k=0; k<2; ++k) {
+		futures.push_back(pcas[k].solve_async());
+		solving[k].get_future().wait();
+	}
+	if (previous>0) assert_equal(previous + 2, stats::utils::get_blas_num_threads(), SPOT);
+	released[0].set_value();
+	futures[0].get();
+	if (previous>0) assert_equal(previous + 2, stats::utils::get_blas_num_threads(), SPOT);
+	released[1].set_value();
+	futures[1].get();
+	assert_equal(previous, stats::utils::get_blas_num_threads(), SPOT);
+	assert_true(pcas[0]==pcas[1], SPOT);
+}
+
+void test_pca::test_progress_callback() {
+	const int nvar = 4;
+	stats::pca pca(nvar);
+	add_records(pca);
+	pca.set_do_bootstrap(true, 12);
+	std::vector<std::string> stages;
+	std::vector<long> replicates;
+	double last_fraction = 0;
+	pca.set_progress_callback([&](const std::string& stage, double fraction, long replicate) {
+		if (stages.empty() || stages.back()!=stage) stages.push_back(stage);
+		if (replicate>=0) replicates.push_back(replicate);
+		last_fraction = fraction;
+	});
+	pca.solve();
+	const std::vector<std::string> exp = {"statistics", "covariance", "eigensolve", "bootstrap"};
+	assert_equal_containers(exp, stages, SPOT);
+	std::sort(replicates.begin(), replicates.end());
+	std::vector<long> exp_replicates(12);
+	std::iota(exp_replicates.begin(), exp_replicates.end(), 0);
+	assert_equal_containers(exp_replicates, replicates, SPOT);
+	assert_approx_equal(1., last_fraction, 1e-12, SPOT);
+}
+
+void test_pca::test_cancellation() {
+	const int nvar = 4;
+	stats::pca pca(nvar);
+	add_records(pca);
+	stats::cancellation_token token;
+	pca.set_cancellation_token(token);
+	token.cancel();
+	assert_true(token.is_cancelled(), SPOT);
+	assert_throw<stats::solve_cancelled>([&pca]() { pca.solve(); }, SPOT);
+
+	token.reset();
+	pca.solve();
+	const auto model = pca.get_model();
+	pca.set_do_bootstrap(true, 20);
+	pca.set_progress_callback([&token](const std::string& stage, double fraction, long replicate) {
+		if (replicate==3) token.cancel();
+	});
+	assert_throw<stats::solve_cancelled>([&pca]() { pca.solve(); }, SPOT);
+	assert_true(model==pca.get_model(), SPOT);
+}
+
+void test_pca::test_time_budget() {
+	const int nvar = 4;
+	stats::pca pca(nvar);
+	add_records(pca);
+	assert_equal(0., pca.get_time_budget(), SPOT);
+	assert_throw<std::invalid_argument>(std::bind(&stats::pca::set_time_budget, &pca, -1.), SPOT);
+	pca.set_do_bootstrap(true, 20);
+	pca.set_time_budget(1e-12);
+	pca.solve();
+	assert_equal(0, long(pca.get_energy_boot().size()), SPOT);
+
+	pca.set_time_budget(0);
+	pca.solve();
+	assert_equal(20, long(pca.get_energy_boot().size()), SPOT);
+	assert_equal(20, long(pca.get_eigenvalue_boot(nvar - 1).size()), SPOT);
+}
+
+void test_pca::test_solve_all() {
+	std::vector<stats::pca> models;
+	for (int m=0; m<6; ++m) {
+		const int nvar = 2 + 3 * m;
+		models.push_back(stats::pca(nvar));
+		if (m % 2) models.back().set_do_bootstrap(true, 10, m);
+		for (int i=0; i<30 + 10 * m; ++i) {
+			std::vector<double> record(nvar);
+			for (int j=0; j<nvar; ++j)
+				record[j] = ((i * (j + 3) + m) % 13) * (j + 1) + 0.1 * (i % 7);
+			models.back().add_record(record);
+		}
+	}
+	std::vector<stats::pca> expected = models;
+	for (auto& model : expected)
+		model.solve();
+
+	std::vector<stats::pca*> pointers;
+	for (auto& model : models)
+		pointers.push_back(&model);
+	stats::solve_all(pointers, std::make_shared<stats::thread_pool>(3));
+	for (size_t m=0; m<models.size(); ++m)
+		assert_true(expected[m]==models[m], SPOT);
+
+	stats::pca empty(3);
+	pointers.push_back(&empty);
+	assert_throw<std::logic_error>([&pointers]() { stats::solve_all(pointers); }, SPOT);
+}
@@ -25,6 +25,30 @@ struct test_pca : utils::mytestcase {
 		RUN(test_pca, test_energy)
 		RUN(test_pca, test_check_eigenvectors_orthogonal)
 		RUN(test_pca, test_projections_to_space)
+		RUN(test_pca, test_single_precision)
+		RUN(test_pca, test_mixed_precision_solver)
+		RUN(test_pca, test_em_solver)
+		RUN(test_pca, test_tsqr_solver)
+		RUN(test_pca, test_svd_solver)
+		RUN(test_pca, test_packed_solver)
+		RUN(test_pca, test_auto_solver)
+		RUN(test_pca, test_missing_values)
+		RUN(test_pca, test_weighted_records)
+		RUN(test_pca, test_thread_pool)
+		RUN(test_pca, test_memory_placement)
+		RUN(test_pca, test_memory_resource)
+		RUN(test_pca, test_views)
+		RUN(test_pca, test_batch_projection)
+		RUN(test_pca, test_concurrent_ingestion)
+		RUN(test_pca, test_ingestion_after_solve)
+		RUN(test_pca, test_model_snapshots)
+		RUN(test_pca, test_solve_async)
+		RUN(test_pca, test_add_during_solve_async)
+		RUN(test_pca, test_overlapping_blas_threads)
+		RUN(test_pca, test_progress_callback)
+		RUN(test_pca, test_cancellation)
+		RUN(test_pca, test_time_budget)
+		RUN(test_pca, test_solve_all)
 	}
 
     test_pca();
@@ -45,6 +69,30 @@ struct test_pca : utils::mytestcase {
 	void test_energy();
 	void test_check_eigenvectors_orthogonal();
 	void test_projections_to_space();
+	void test_single_precision();
+	void test_mixed_precision_solver();
+	void test_em_solver();
+	void test_tsqr_solver();
+	void test_svd_solver();
+	void test_packed_solver();
+	void test_auto_solver();
+	void test_missing_values();
+	void test_weighted_records();
+	void test_thread_pool();
+	void test_memory_placement();
+	void test_memory_resource();
+	void test_views();
+	void test_batch_projection();
+	void test_concurrent_ingestion();
+	void test_ingestion_after_solve();
+	void test_model_snapshots();
+	void test_solve_async();
+	void test_add_during_solve_async();
+	void test_overlapping_blas_threads();
+	void test_progress_callback();
+	void test_cancellation();
+	void test_time_budget();
+	void test_solve_all();
 
 private:
     std::vector<std::string> tmp_files;
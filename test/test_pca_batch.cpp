@@ -0,0 +1,115 @@
+/**
+ * @file test_pca_batch.cpp
+ * @brief Unit tests for the class template stats::basic_pca_batch
+ */
+#include "test_pca_batch.h"
+
+using namespace std;
+
+vector<double> test_pca_batch::make_record(long model, long index, long num_vars) const {
+	vector<double> record(num_vars);
+	for (long j=0; j<num_vars; ++j)
+		record[j] = ((index * (j + 3) + model * 7) % 17) * (j + 1) + 0.1 * ((index + j) % 5);
+	return record;
+}
+
+void test_pca_batch::test_add_model() {
+	stats::pca_batch batch;
+	assert_equal(0, batch.get_num_models(), SPOT);
+	assert_equal(0, batch.add_model(3), SPOT);
+	assert_equal(1, batch.add_model(8), SPOT);
+	assert_equal(2, batch.get_num_models(), SPOT);
+	assert_equal(8, batch.get_num_variables(1), SPOT);
+	assert_equal(0, batch.get_num_records(1), SPOT);
+	assert_throw<std::invalid_argument>(std::bind(&stats::pca_batch::add_model, &batch, 1), SPOT);
+	assert_throw<std::range_error>(std::bind(&stats::pca_batch::get_num_variables, &batch, 2), SPOT);
+	assert_throw<std::invalid_argument>(std::bind(&stats::pca_batch::set_solver, &batch, "foo"), SPOT);
+}
+
+void test_pca_batch::test_add_record_throws() {
+	stats::pca_batch batch;
+	batch.add_model(3);
+	batch.add_record(0, {1, 2, 3});
+	assert_equal(1, batch.get_num_records(0), SPOT);
+	assert_throw<std::domain_error>([&batch]() { batch.add_record(0, {1, 2}); }, SPOT);
+	assert_throw<std::range_error>([&batch]() { batch.add_record(1, {1, 2, 3}); }, SPOT);
+}
+
+void test_pca_batch::test_solve_throws() {
+	stats::pca_batch batch;
+	batch.add_model(3);
+	batch.add_record(0, {1, 2, 3});
+	assert_throw<std::logic_error>(std::bind(&stats::pca_batch::solve, &batch), SPOT);
+	batch.add_record(0, {1, 4, 5});
+	batch.set_do_normalize(true);
+	assert_throw<std::runtime_error>(std::bind(&stats::pca_batch::solve, &batch), SPOT);
+}
+
+void test_pca_batch::test_same_as_pca() {
+	const vector<long> sizes = {2, 5, 8, 13};
+	for (int variant=0; variant<4; ++variant) {
+		const bool do_normalize = variant % 2;
+		stats::pca_batch batch;
+		batch.set_do_normalize(do_normalize);
+		batch.set_solver(variant<2 ? "dc" : "packed");
+		vector<stats::pca> singles;
+		for (long m=0; m<long(sizes.size()); ++m) {
+			batch.add_model(sizes[m]);
+			singles.push_back(stats::pca(sizes[m]));
+			singles.back().set_do_normalize(do_normalize);
+			for (long r=0; r<40; ++r) {
+				const auto record = make_record(m, r, sizes[m]);
+				batch.add_record(m, record);
+				singles.back().add_record(record);
+			}
+			singles.back().solve();
+		}
+		batch.solve();
+		for (long m=0; m<long(sizes.size()); ++m) {
+			const stats::pca& pca = singles[m];
+			const double eps = 1e-9;
+			assert_approx_equal(pca.get_energy(), batch.get_energy(m), pca.get_energy()*eps, SPOT);
+			assert_approx_equal_containers(pca.get_eigenvalues(), batch.get_eigenvalues(m), eps, SPOT);
+			assert_approx_equal_containers(pca.get_mean_values(), batch.get_mean_values(m), eps, SPOT);
+			assert_approx_equal_containers(pca.get_sigma_values(), batch.get_sigma_values(m), eps, SPOT);
+			for (long i=0; i<2; ++i)
+				assert_approx_equal_containers(pca.get_eigenvector(i), batch.get_eigenvector(m, i), 1e-7, SPOT);
+		}
+	}
+}
+
+void test_pca_batch::test_projections_to_space() {
+	stats::fpca_batch batch;
+	batch.set_do_normalize(true);
+	batch.add_model(4);
+	for (long r=0; r<20; ++r) {
+		const auto record = make_record(0, r, 4);
+		batch.add_record(0, vector<float>(record.begin(), record.end()));
+	}
+	batch.solve();
+	const vector<float> record = {3, 8, 1, 20};
+	const auto prin = batch.to_principal_space(0, record);
+	const auto back = batch.to_variable_space(0, prin);
+	assert_approx_equal_containers(record, back, 1e-3, SPOT);
+	assert_throw<std::domain_error>([&batch]() { batch.to_principal_space(0, {1, 2}); }, SPOT);
+	assert_throw<std::range_error>([&batch]() { batch.get_eigenvector(0, 4); }, SPOT);
+}
+
+void test_pca_batch::test_threads_agree() {
+	stats::pca_batch batch1;
+	batch1.set_num_threads(1);
+	for (long m=0; m<300; ++m) {
+		const long num_vars = 2 + m % 9;
+		batch1.add_model(num_vars);
+		for (long r=0; r<10; ++r)
+			batch1.add_record(m, make_record(m, r, num_vars));
+	}
+	stats::pca_batch batch4 = batch1;
+	batch4.set_num_threads(4);
+	batch1.solve();
+	batch4.solve();
+	for (long m=0; m<300; m+=7) {
+		assert_equal_containers(batch1.get_eigenvalues(m), batch4.get_eigenvalues(m), SPOT);
+		assert_equal_containers(batch1.get_eigenvector(m, 0), batch4.get_eigenvector(m, 0), SPOT);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+/**
+ * @file test_pca_batch.h
+ * @brief Unit tests for the class template stats::basic_pca_batch
+ */
+#include "pca_batch.h"
+#include "utils.hpp"
+
+
+struct test_pca_batch : utils::mytestcase {
+
+	static void run() {
+		RUN(test_pca_batch, test_add_model)
+		RUN(test_pca_batch, test_add_record_throws)
+		RUN(test_pca_batch, test_solve_throws)
+		RUN(test_pca_batch, test_same_as_pca)
+		RUN(test_pca_batch, test_projections_to_space)
+		RUN(test_pca_batch, test_threads_agree)
+	}
+
+	void test_add_model();
+	void test_add_record_throws();
+	void test_solve_throws();
+	void test_same_as_pca();
+	void test_projections_to_space();
+	void test_threads_agree();
+
+private:
+	std::vector<double> make_record(long model, long index, long num_vars) const;
+};
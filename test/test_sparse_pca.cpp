@@ -0,0 +1,122 @@
+/**
+ * @file test_sparse_pca.cpp
+ * @brief Unit tests for the class template stats::basic_sparse_pca
+ */
+#include "test_sparse_pca.h"
+#include <random>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+// sparse records with two dominant patterns plus sparse noise
+vector<vector<double>> make_records(long num_records, long num_vars) {
+	std::mt19937 generator(3);
+	std::uniform_real_distribution<double> uniform;
+	vector<vector<double>> records(num_records, vector<double>(num_vars, 0.));
+	for (long i=0; i<num_records; ++i) {
+		if (uniform(generator) < 0.5)
+			for (long j=0; j<5; ++j) records[i][j] = 6 * uniform(generator) + j;
+		if (uniform(generator) < 0.3)
+			for (long j=10; j<14; ++j) records[i][j] = 3 * uniform(generator);
+		for (long k=0; k<3; ++k)
+			records[i][long(uniform(generator) * num_vars)] += uniform(generator);
+	}
+	return std::move(records);
+}
+
+}
+
+void test_sparse_pca::test_add_record_throws() {
+	assert_throw<std::invalid_argument>([]() { stats::sparse_pca pca(1); }, SPOT);
+	stats::sparse_pca pca(5);
+	assert_throw<std::domain_error>([&pca]() { pca.add_record({1, 2}, {1.}); }, SPOT);
+	assert_throw<std::range_error>([&pca]() { pca.add_record({1, 5}, {1., 2.}); }, SPOT);
+	assert_throw<std::invalid_argument>([&pca]() { pca.add_record({3, 1, 3}, {1., 2., 3.}); }, SPOT);
+	assert_throw<std::domain_error>([&pca]() { pca.add_record(vector<double>{1, 2}); }, SPOT);
+	assert_equal(0, pca.get_num_records(), SPOT);
+	pca.add_record({4, 0}, {2., 0.});
+	pca.add_record(vector<double>{0, 1, 0, 0, 3});
+	assert_equal(2, pca.get_num_records(), SPOT);
+	assert_equal(3, pca.get_num_nonzeros(), SPOT);
+}
+
+void test_sparse_pca::test_solve_throws() {
+	stats::sparse_pca pca(3);
+	pca.add_record({0}, {1.});
+	assert_throw<std::logic_error>([&pca]() { pca.solve(); }, SPOT);
+	assert_throw<std::logic_error>([&pca]() { pca.to_principal_space(vector<double>{1, 2, 3}); }, SPOT);
+	pca.add_record({1}, {1.});
+	pca.set_do_normalize(true);
+	assert_throw<std::runtime_error>([&pca]() { pca.solve(); }, SPOT);
+	pca.set_do_normalize(false);
+	pca.solve();
+	assert_equal(2, long(pca.get_eigenvalues().size()), SPOT);
+	assert_throw<std::range_error>([&pca]() { pca.get_eigenvector(2); }, SPOT);
+}
+
+void test_sparse_pca::compare_with_pca_(bool do_normalize) {
+	const long nvar = 40;
+	const long ncomp = 2;
+	const auto records = make_records(400, nvar);
+	stats::pca dense(nvar);
+	dense.set_do_normalize(do_normalize);
+	stats::sparse_pca sparse(nvar);
+	sparse.set_do_normalize(do_normalize);
+	sparse.set_num_components(ncomp);
+	sparse.set_num_iterations(30);
+	for (const auto& record : records) {
+		dense.add_record(record);
+		sparse.add_record(record);
+	}
+	dense.solve();
+	sparse.solve();
+	assert_approx_equal(dense.get_energy(), sparse.get_energy(), 1e-8, SPOT);
+	assert_approx_equal_containers(dense.get_mean_values(), sparse.get_mean_values(), 1e-10, SPOT);
+	assert_approx_equal_containers(dense.get_sigma_values(), sparse.get_sigma_values(), 1e-10, SPOT);
+	for (long i=0; i<ncomp; ++i) {
+		assert_approx_equal(dense.get_eigenvalue(i), sparse.get_eigenvalue(i), 1e-8, SPOT);
+		assert_approx_equal_containers(dense.get_eigenvector(i), sparse.get_eigenvector(i), 1e-6, SPOT);
+	}
+	for (long r=0; r<20; ++r) {
+		const auto exp = dense.to_principal_space(records[r]);
+		const auto act = sparse.to_principal_space(records[r]);
+		for (long i=0; i<ncomp; ++i)
+			assert_approx_equal(exp[i], act[i], 1e-6, SPOT);
+	}
+}
+
+void test_sparse_pca::test_same_as_pca() {
+	compare_with_pca_(false);
+}
+
+void test_sparse_pca::test_same_as_pca_normalized() {
+	compare_with_pca_(true);
+}
+
+void test_sparse_pca::test_num_threads() {
+	const long nvar = 3000;
+	std::mt19937 generator(5);
+	std::uniform_int_distribution<long> index(0, nvar - 1);
+	stats::fsparse_pca serial(nvar);
+	serial.set_num_components(4);
+	serial.set_num_threads(1);
+	for (long r=0; r<1500; ++r) {
+		vector<long> indices;
+		vector<float> values;
+		for (long k=0; k<6; ++k) {
+			const long j = index(generator);
+			if (find(indices.begin(), indices.end(), j)!=indices.end()) continue;
+			indices.push_back(j);
+			values.push_back(1 + (r + k) % 4);
+		}
+		serial.add_record(indices, values);
+	}
+	stats::fsparse_pca parallel(serial);
+	parallel.set_num_threads(3);
+	serial.solve();
+	parallel.solve();
+	assert_equal_containers(serial.get_eigenvalues(), parallel.get_eigenvalues(), SPOT);
+	assert_equal_containers(serial.get_eigenvector(0), parallel.get_eigenvector(0), SPOT);
+}
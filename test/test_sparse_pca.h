@@ -0,0 +1,29 @@
+#pragma once
+/**
+ * @file test_sparse_pca.h
+ * @brief Unit tests for the class template stats::basic_sparse_pca
+ */
+#include "sparse_pca.h"
+#include "utils.hpp"
+
+
+struct test_sparse_pca : utils::mytestcase {
+
+	static void run() {
+		RUN(test_sparse_pca, test_add_record_throws)
+		RUN(test_sparse_pca, test_solve_throws)
+		RUN(test_sparse_pca, test_same_as_pca)
+		RUN(test_sparse_pca, test_same_as_pca_normalized)
+		RUN(test_sparse_pca, test_num_threads)
+	}
+
+	void test_add_record_throws();
+	void test_solve_throws();
+	void test_same_as_pca();
+	void test_same_as_pca_normalized();
+	void test_num_threads();
+
+private:
+
+	void compare_with_pca_(bool do_normalize);
+};
@@ -0,0 +1,198 @@
+/**
+ * @file test_thread_pool.cpp
+ * @brief Unit tests for the class stats::thread_pool
+ */
+#include "test_thread_pool.h"
+#include <atomic>
+#include <stdexcept>
+#include <memory>
+#include <future>
+#include <chrono>
+
+using namespace std;
+
+void test_thread_pool::test_constructor_throws() {
+	struct Functor {
+	    void operator()(long arg1) {
+		stats::thread_pool pool(arg1);
+	}} functor;
+	assert_throw<std::invalid_argument>(std::bind(functor, 0), SPOT);
+	assert_no_throw(std::bind(functor, 1), SPOT);
+	struct Functor2 {
+	    void operator()(long arg1) {
+		stats::thread_pool pool(2, {arg1});
+	}} functor2;
+	assert_throw<std::invalid_argument>(std::bind(functor2, -1), SPOT);
+	assert_no_throw(std::bind(functor2, 0), SPOT);
+}
+
+void test_thread_pool::test_get_num_threads() {
+	stats::thread_pool pool(3);
+	assert_equal(3, pool.get_num_threads(), SPOT);
+	assert_true(stats::thread_pool::get_default()->get_num_threads()>=1, SPOT);
+}
+
+void test_thread_pool::test_parallel_for() {
+	stats::thread_pool pool(4);
+	vector<int> counts(1000, 0);
+	pool.parallel_for(0, 1000, 7, [&counts](long first, long last) {
+		for (long i=first; i<last; ++i)
+			++counts[i];
+	});
+	assert_equal_containers(vector<int>(1000, 1), counts, SPOT);
+}
+
+void test_thread_pool::test_parallel_for_chunks() {
+	stats::thread_pool pool(4);
+	vector<long> sizes(4, 0);
+	pool.parallel_for(10, 20, 3, [&sizes](long first, long last) {
+		sizes[(first - 10) / 3] = last - first;
+	});
+	const vector<long> exp = {3, 3, 3, 1};
+	assert_equal_containers(exp, sizes, SPOT);
+}
+
+void test_thread_pool::test_parallel_for_nested() {
+	stats::thread_pool pool(3);
+	std::atomic<long> sum(0);
+	pool.parallel_for(0, 10, 1, [&](long first, long last) {
+		pool.parallel_for(0, 100, 10, [&](long first2, long last2) {
+			sum += last2 - first2;
+		});
+	});
+	assert_equal(1000, sum.load(), SPOT);
+}
+
+void test_thread_pool::test_parallel_for_throws() {
+	stats::thread_pool pool(4);
+	struct Functor {
+		stats::thread_pool* pool;
+	    void operator()() {
+			pool->parallel_for(0, 100, 1, [](long first, long last) {
+				if (first==42) throw std::runtime_error("42");
+			});
+	}} functor = {&pool};
+	assert_throw<std::runtime_error>(functor, SPOT);
+}
+
+void test_thread_pool::test_affinity() {
+	stats::thread_pool pool(3, {0});
+	const vector<long> exp = {0};
+	assert_equal_containers(exp, pool.get_affinity(), SPOT);
+	assert_true(stats::thread_pool(2).get_affinity().empty(), SPOT);
+	std::atomic<long> sum(0);
+	pool.parallel_for(0, 100, 1, [&sum](long first, long last) {
+		sum += last - first;
+	});
+	assert_equal(100, sum.load(), SPOT);
+}
+
+void test_thread_pool::test_scoped_thread_pool() {
+	auto pool = std::make_shared<stats::thread_pool>(3);
+	auto other = std::make_shared<stats::thread_pool>(2);
+	assert_equal(stats::thread_pool::get_default().get(), &stats::thread_pool::get_current(), SPOT);
+	{
+		stats::scoped_thread_pool scope(pool);
+		assert_equal(pool.get(), &stats::thread_pool::get_current(), SPOT);
+		{
+			stats::scoped_thread_pool inner(other);
+			assert_equal(other.get(), &stats::thread_pool::get_current(), SPOT);
+		}
+		assert_equal(pool.get(), &stats::thread_pool::get_current(), SPOT);
+		std::atomic<long> mismatches(0);
+		pool->parallel_for(0, 20, 1, [&](long first, long last) {
+			if (&stats::thread_pool::get_current()!=pool.get()) ++mismatches;
+		});
+		assert_equal(0, mismatches.load(), SPOT);
+	}
+	assert_equal(stats::thread_pool::get_default().get(), &stats::thread_pool::get_current(), SPOT);
+}
+
+void test_thread_pool::test_set_default() {
+	const auto previous = stats::thread_pool::get_default();
+	auto pool = std::make_shared<stats::thread_pool>(2);
+	stats::thread_pool::set_default(pool);
+	assert_equal(pool.get(), stats::thread_pool::get_default().get(), SPOT);
+	assert_equal(2, stats::thread_pool::get_current().get_num_threads(), SPOT);
+	stats::thread_pool::set_default(previous);
+	assert_equal(previous.get(), stats::thread_pool::get_default().get(), SPOT);
+	assert_throw<std::invalid_argument>(std::bind(stats::thread_pool::set_default, std::shared_ptr<stats::thread_pool>()), SPOT);
+}
+
+void test_thread_pool::test_blas_num_threads() {
+	stats::thread_pool pool(3);
+	assert_equal(3, pool.get_blas_num_threads(), SPOT);
+	pool.set_blas_num_threads(1);
+	assert_equal(1, pool.get_blas_num_threads(), SPOT);
+	assert_throw<std::invalid_argument>(std::bind(&stats::thread_pool::set_blas_num_threads, &pool, -1), SPOT);
+	const long previous = stats::utils::get_blas_num_threads();
+	assert_true(previous>=0, SPOT);
+	{
+		stats::utils::scoped_blas_threads blas_threads(1);
+		if (previous>0) assert_equal(1, stats::utils::get_blas_num_threads(), SPOT);
+	}
+	assert_equal(previous, stats::utils::get_blas_num_threads(), SPOT);
+}
+
+void test_thread_pool::test_submit() {
+	stats::thread_pool pool(1);
+	std::promise<void> started;
+	std::future<void> started_future = started.get_future();
+	auto done = pool.submit([&started_future]() {
+		started_future.wait();
+	});
+	started.set_value();
+	assert_true(done.wait_for(std::chrono::seconds(10))==std::future_status::ready, SPOT);
+	assert_no_throw([&done]() { done.get(); }, SPOT);
+
+	auto failed = pool.submit([]() { throw std::runtime_error("failed"); });
+	assert_throw<std::runtime_error>([&failed]() { failed.get(); }, SPOT);
+
+	stats::thread_pool pool4(4);
+	std::atomic<long> sum(0);
+	std::vector<std::future<void>> futures;
+	for (int i=0; i<10; ++i) {
+		futures.push_back(pool4.submit([&pool4, &sum]() {
+			pool4.parallel_for(0, 10, 1, [&sum](long first, long last) {
+				sum += last - first;
+			});
+		}));
+	}
+	for (auto& future : futures)
+		future.get();
+	assert_equal(100, sum.load(), SPOT);
+}
+
+void test_thread_pool::test_parallel_for_largest_first() {
+	stats::thread_pool pool(1);
+	const vector<double> costs = {3, 10, 1, 7, 7};
+	vector<long> order;
+	pool.parallel_for_largest_first(costs, [&order](long index) {
+		order.push_back(index);
+	});
+	const vector<long> exp = {1, 3, 4, 0, 2};
+	assert_equal_containers(exp, order, SPOT);
+
+	stats::thread_pool pool4(4);
+	vector<int> counts(100, 0);
+	vector<double> costs4(100);
+	for (int i=0; i<100; ++i) costs4[i] = (i * 37) % 11;
+	pool4.parallel_for_largest_first(costs4, [&counts](long index) {
+		++counts[index];
+	});
+	assert_equal_containers(vector<int>(100, 1), counts, SPOT);
+}
+
+void test_thread_pool::test_work_stealing_nested() {
+	stats::thread_pool pool(4);
+	const vector<double> costs = {1000, 1, 1, 1, 500, 1, 1};
+	std::atomic<long> sum(0);
+	pool.parallel_for_largest_first(costs, [&](long index) {
+		pool.parallel_for(0, long(costs[index]), 10, [&](long first, long last) {
+			pool.parallel_for(first, last, 3, [&](long first2, long last2) {
+				sum += last2 - first2;
+			});
+		});
+	});
+	assert_equal(1505, sum.load(), SPOT);
+}
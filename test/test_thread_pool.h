@@ -0,0 +1,41 @@
+#pragma once
+/**
+ * @file test_thread_pool.h
+ * @brief Unit tests for the class stats::thread_pool
+ */
+#include "thread_pool.h"
+#include "utils.hpp"
+
+
+struct test_thread_pool : utils::mytestcase {
+
+	static void run() {
+		RUN(test_thread_pool, test_constructor_throws)
+		RUN(test_thread_pool, test_get_num_threads)
+		RUN(test_thread_pool, test_parallel_for)
+		RUN(test_thread_pool, test_parallel_for_chunks)
+		RUN(test_thread_pool, test_parallel_for_nested)
+		RUN(test_thread_pool, test_parallel_for_throws)
+		RUN(test_thread_pool, test_affinity)
+		RUN(test_thread_pool, test_scoped_thread_pool)
+		RUN(test_thread_pool, test_set_default)
+		RUN(test_thread_pool, test_blas_num_threads)
+		RUN(test_thread_pool, test_submit)
+		RUN(test_thread_pool, test_parallel_for_largest_first)
+		RUN(test_thread_pool, test_work_stealing_nested)
+	}
+
+	void test_constructor_throws();
+	void test_get_num_threads();
+	void test_parallel_for();
+	void test_parallel_for_chunks();
+	void test_parallel_for_nested();
+	void test_parallel_for_throws();
+	void test_affinity();
+	void test_scoped_thread_pool();
+	void test_set_default();
+	void test_blas_num_threads();
+	void test_submit();
+	void test_parallel_for_largest_first();
+	void test_work_stealing_nested();
+};
@@ -32,6 +32,23 @@ void test_utils::test_make_shuffled_matrix() {
 	assert_equal_containers(exp, result, SPOT);
 }
 
+void test_utils::test_refine_symmetric_eigenpairs() {
+	const vector<double> vec = {4,1,0,1,3,1,0,1,2};
+	const arma::Mat<double> data(&vec.front(), 3, 3);
+	arma::Col<double> exp_eigval;
+	arma::Mat<double> exp_eigvec;
+	arma::eig_sym(exp_eigval, exp_eigvec, data);
+
+	arma::Col<double> eigval = exp_eigval + 1e-3;
+	arma::Mat<double> eigvec = exp_eigvec + 1e-3;
+	refine_symmetric_eigenpairs(eigval, eigvec, data, 3);
+	assert_approx_equal_containers(exp_eigval, eigval, 1e-12, SPOT);
+	assert_approx_equal_containers(exp_eigvec, eigvec, 1e-12, SPOT);
+
+	arma::Mat<double> wrong(2, 2);
+	assert_throw<std::range_error>(std::bind(refine_symmetric_eigenpairs, eigval, wrong, data, 1), SPOT);
+}
+
 void test_utils::test_compute_column_means() {
 	const vector<double> vec = {1,2,3,4,5,6,7,8,9};
 	const arma::Mat<double> data(&vec.front(), 3, 3);
@@ -53,7 +70,7 @@ void test_utils::test_remove_column_means() {
 void test_utils::test_remove_column_means_throws() {
 	arma::Mat<double> data(3, 3);
 	const arma::Col<double> means(2);
-	assert_throw<std::range_error>(std::bind(remove_column_means, data, means), SPOT);
+	assert_throw<std::range_error>(std::bind(remove_column_means<double>, data, means), SPOT);
 }
 
 void test_utils::test_compute_column_rms() {
@@ -82,9 +99,9 @@ void test_utils::test_normalize_by_column() {
 void test_utils::test_normalize_by_column_throws() {
 	arma::Mat<double> data(3, 3);
 	const arma::Col<double> sigmas1(2);
-	assert_throw<std::range_error>(std::bind(normalize_by_column, data, sigmas1), SPOT);
+	assert_throw<std::range_error>(std::bind(normalize_by_column<double>, data, sigmas1), SPOT);
 	const arma::Col<double> sigmas2 = {0, 0, 0};
-	assert_throw<std::runtime_error>(std::bind(normalize_by_column, data, sigmas2), SPOT);
+	assert_throw<std::runtime_error>(std::bind(normalize_by_column<double>, data, sigmas2), SPOT);
 }
 
 void test_utils::test_enforce_positive_sign_by_column() {
@@ -107,7 +124,7 @@ void test_utils::test_extract_column_vector() {
 void test_utils::test_extract_column_vector_throws() {
 	const arma::Mat<double> data(3, 3);
 	const int index = 3;
-	assert_throw<std::range_error>(std::bind(extract_column_vector, data, index), SPOT);
+	assert_throw<std::range_error>(std::bind(extract_column_vector<double>, data, index), SPOT);
 }
 
 void test_utils::test_extract_row_vector() {
@@ -121,7 +138,7 @@ void test_utils::test_extract_row_vector() {
 void test_utils::test_extract_row_vector_throws() {
 	const arma::Mat<double> data(3, 3);
 	const int index = 3;
-	assert_throw<std::range_error>(std::bind(extract_row_vector, data, index), SPOT);
+	assert_throw<std::range_error>(std::bind(extract_row_vector<double>, data, index), SPOT);
 }
 
 void test_utils::test_assert_file_good() {
@@ -199,3 +216,206 @@ void test_utils::test_join() {
 	const std::string exp2 = "something123cool";
 	assert_equal(exp2, join("something", 123, "cool"), SPOT);
 }
+
+void test_utils::test_set_instruction_set() {
+	const std::string active = get_instruction_set();
+	set_instruction_set("generic");
+	assert_equal("generic", get_instruction_set(), SPOT);
+	const std::string isa = "sse1";
+	assert_throw<std::invalid_argument>(std::bind(set_instruction_set, isa), SPOT);
+	set_instruction_set(active);
+	assert_equal(active, get_instruction_set(), SPOT);
+}
+
+void test_utils::test_instruction_sets_agree() {
+	const std::string active = get_instruction_set();
+	arma::Mat<double> data(37, 3);
+	for (auto& value : data)
+		value = rand()%100 - 50.5;
+	const arma::Mat<float> fdata = arma::conv_to<arma::Mat<float>>::from(data);
+
+	set_instruction_set("generic");
+	const auto exp_means = compute_column_means(data);
+	const auto exp_rms = compute_column_rms(data);
+	const auto exp_fmeans = compute_column_means(fdata);
+
+	for (auto isa : {"avx2", "avx512"}) {
+		try {
+			set_instruction_set(isa);
+		} catch (const std::invalid_argument&) {
+			continue;
+		}
+		assert_approx_equal_containers(exp_means, compute_column_means(data), 1e-12, SPOT);
+		assert_approx_equal_containers(exp_rms, compute_column_rms(data), 1e-12, SPOT);
+		assert_approx_equal_containers(exp_fmeans, compute_column_means(fdata), utils::feps, SPOT);
+
+		arma::Mat<double> centered = data;
+		remove_column_means(centered, exp_means);
+		normalize_by_column(centered, exp_rms);
+		arma::Mat<double> exp_centered = data;
+		for (long i=0; i<3; ++i)
+			exp_centered.col(i) = (exp_centered.col(i) - exp_means(i)) / exp_rms(i);
+		assert_approx_equal_containers(exp_centered, centered, 1e-12, SPOT);
+	}
+	set_instruction_set(active);
+}
+
+void test_utils::test_column_statistics_tall() {
+	const long n_rows = 150001;
+	arma::Mat<double> data(n_rows, 2);
+	for (long i=0; i<n_rows; ++i) {
+		data(i, 0) = i % 7;
+		data(i, 1) = 2 * (i % 7) + 1;
+	}
+	const auto means = compute_column_means(data);
+	const double exp_mean = 449998. / n_rows;
+	assert_approx_equal(exp_mean, means(0), 1e-12, SPOT);
+	assert_approx_equal(2 * exp_mean + 1, means(1), 1e-12, SPOT);
+	remove_column_means(data, means);
+	const auto rms = compute_column_rms(data);
+	normalize_by_column(data, rms);
+	const auto normalized_rms = compute_column_rms(data);
+	const arma::Col<double> exp = {1, 1};
+	assert_approx_equal_containers(exp, normalized_rms, 1e-12, SPOT);
+	assert_approx_equal(0., compute_column_means(data)(1), 1e-12, SPOT);
+}
+
+void test_utils::test_covariance_matrix_tall() {
+	const long n_rows = 20001;
+	arma::Mat<double> data(n_rows, 3);
+	for (long i=0; i<n_rows; ++i) {
+		data(i, 0) = i % 5;
+		data(i, 1) = i % 3 - 1.;
+		data(i, 2) = (i % 5) * 0.5 + 2.;
+	}
+	arma::Mat<double> exp(3, 3);
+	for (long j=0; j<3; ++j)
+		for (long k=0; k<3; ++k)
+			exp(j, k) = arma::dot(data.col(j), data.col(k)) / (n_rows - 1);
+	arma::Mat<double> cov_single;
+	{
+		stats::scoped_thread_pool scope(std::make_shared<stats::thread_pool>(1));
+		cov_single = make_covariance_matrix(data);
+	}
+	arma::Mat<double> cov_multi;
+	{
+		stats::scoped_thread_pool scope(std::make_shared<stats::thread_pool>(4));
+		cov_multi = make_covariance_matrix(data);
+	}
+	assert_approx_equal_containers(exp, cov_single, 1e-9, SPOT);
+	assert_equal_containers(cov_single, cov_multi, SPOT);
+	const arma::Mat<float> fdata = arma::conv_to<arma::Mat<float>>::from(data);
+	assert_approx_equal_containers(exp, make_covariance_matrix(fdata), 1e-9, SPOT);
+}
+
+void test_utils::test_choose_solver() {
+	assert_throw<std::invalid_argument>([]() { estimate_solve_seconds("java_sucks", 100, 10, 10, 1); }, SPOT);
+	assert_throw<std::invalid_argument>([]() { estimate_solve_seconds("dc", 1, 10, 10, 1); }, SPOT);
+	assert_throw<std::invalid_argument>([]() { choose_solver(100, 10, 0); }, SPOT);
+	for (const std::string solver : {"standard", "dc", "mixed", "em", "tsqr", "svd"}) {
+		const double seconds = estimate_solve_seconds(solver, 1000, 20, 20, 1);
+		assert_true(seconds > 0, SPOT);
+		assert_true(estimate_solve_seconds(solver, 2000, 20, 20, 1) > seconds, SPOT);
+	}
+	// more threads only shorten the parallel stages
+	assert_true(estimate_solve_seconds("dc", 100000, 50, 50, 4) < estimate_solve_seconds("dc", 100000, 50, 50, 1), SPOT);
+	// few components of many variables favour the em solver
+	assert_true(estimate_solve_seconds("em", 2000, 2000, 1, 1) < estimate_solve_seconds("dc", 2000, 2000, 1, 1), SPOT);
+	// the choice is restricted to solvers returning all eigenpairs
+	const std::vector<std::string> solvers = {"dc", "packed", "tsqr", "svd"};
+	const std::string chosen = choose_solver(1000, 20, 2);
+	assert_true(std::find(solvers.begin(), solvers.end(), chosen)!=solvers.end(), SPOT);
+	const std::string chosen_tall = choose_solver(2000, 2000, 1);
+	assert_true(std::find(solvers.begin(), solvers.end(), chosen_tall)!=solvers.end(), SPOT);
+	const std::string chosen_wide = choose_solver(100, 2000, 1);
+	assert_true(chosen_wide=="dc" || chosen_wide=="packed", SPOT);
+}
+
+void test_utils::test_packed_covariance_matrix() {
+	const long n_rows = 9000;
+	const long n_cols = 300;
+	arma::Mat<double> data(n_rows, n_cols);
+	for (long j=0; j<n_cols; ++j)
+		for (long i=0; i<n_rows; ++i)
+			data(i, j) = ((i * (j + 3) + j * 7) % 17) - 8. + 0.25 * ((i + j) % 5);
+	const arma::Mat<double> cov_mat = make_covariance_matrix(data);
+	arma::Col<double> packed_single;
+	{
+		stats::scoped_thread_pool scope(std::make_shared<stats::thread_pool>(1));
+		packed_single = make_packed_covariance_matrix(data);
+	}
+	arma::Col<double> packed_multi;
+	{
+		stats::scoped_thread_pool scope(std::make_shared<stats::thread_pool>(3));
+		packed_multi = make_packed_covariance_matrix(data);
+	}
+	assert_equal(n_cols * (n_cols + 1) / 2, long(packed_single.n_elem), SPOT);
+	assert_equal_containers(packed_single, packed_multi, SPOT);
+	for (long j=0; j<n_cols; ++j)
+		for (long i=0; i<=j; ++i)
+			assert_approx_equal(cov_mat(i, j), packed_single[i + j * (j + 1) / 2], 1e-9, SPOT);
+	const arma::Mat<float> fdata = arma::conv_to<arma::Mat<float>>::from(data);
+	assert_approx_equal_containers(packed_single, make_packed_covariance_matrix(fdata), 1e-9, SPOT);
+}
+
+void test_utils::test_eig_sym_packed() {
+	arma::Mat<double> mat(4, 4);
+	arma::Col<double> packed(10);
+	for (long j=0; j<4; ++j) {
+		for (long i=0; i<=j; ++i) {
+			mat(i, j) = mat(j, i) = (i==j ? 5. + j : 1. / (1 + i + j));
+			packed[i + j * (j + 1) / 2] = mat(i, j);
+		}
+	}
+	arma::Col<double> exp_eigval;
+	arma::Mat<double> exp_eigvec;
+	arma::eig_sym(exp_eigval, exp_eigvec, mat);
+	arma::Col<double> eigval;
+	arma::Mat<double> eigvec;
+	eig_sym_packed(eigval, eigvec, packed, 4);
+	assert_approx_equal_containers(exp_eigval, eigval, 1e-12, SPOT);
+	for (long k=0; k<4; ++k) {
+		const arma::Col<double> residual = mat * eigvec.col(k) - eigvec.col(k) * eigval(k);
+		assert_approx_equal(0., arma::norm(residual, 2), 1e-12, SPOT);
+	}
+	arma::Col<double> wrong(9);
+	assert_throw<std::range_error>([&]() { eig_sym_packed(eigval, eigvec, wrong, 4); }, SPOT);
+}
+
+void test_utils::test_resize_placed() {
+	assert_true(get_num_numa_nodes() >= 1, SPOT);
+	arma::Mat<double> data(70000, 3);
+	for (long j=0; j<3; ++j)
+		for (long i=0; i<70000; ++i)
+			data(i, j) = i + 0.5 * j;
+	stats::scoped_thread_pool scope(std::make_shared<stats::thread_pool>(3));
+	for (const std::string placement : {"default", "first_touch", "interleave"}) {
+		for (bool use_huge_pages : {false, true}) {
+			arma::Mat<double> expected = data;
+			arma::Mat<double> placed = data;
+			expected.resize(140000, 4);
+			resize_placed(placed, 140000, 4, placement, use_huge_pages);
+			assert_equal_containers(expected, placed, SPOT);
+			expected.resize(1000, 2);
+			resize_placed(placed, 1000, 2, placement, use_huge_pages);
+			assert_equal_containers(expected, placed, SPOT);
+		}
+	}
+	assert_throw<std::invalid_argument>([&]() { resize_placed(data, 10, 3, "nowhere", false); }, SPOT);
+}
+
+void test_utils::test_views() {
+	const arma::Mat<double> data = {{1, 2, 3}, {4, 5, 6}};
+	const stats::vector_view<double> column = view_column(data, 1);
+	assert_equal(data.colptr(1), column.data(), SPOT);
+	assert_equal(2L, column.size(), SPOT);
+	assert_equal(1L, column.stride(), SPOT);
+	assert_equal_containers(extract_column_vector(data, 1), column.to_vector(), SPOT);
+	const stats::vector_view<double> row = view_row(data, 1);
+	assert_equal(3L, row.size(), SPOT);
+	assert_equal(2L, row.stride(), SPOT);
+	assert_equal(6., row[2], SPOT);
+	assert_equal_containers(extract_row_vector(data, 1), row.to_vector(), SPOT);
+	assert_throw<std::range_error>([&]() { view_column(data, 3); }, SPOT);
+	assert_throw<std::range_error>([&]() { view_row(data, -1); }, SPOT);
+}
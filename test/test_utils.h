@@ -12,6 +12,7 @@ struct test_utils : utils::mytestcase {
 	static void run() {
 		RUN(test_utils, test_make_covariance_matrix)
 		RUN(test_utils, test_make_shuffled_matrix)
+		RUN(test_utils, test_refine_symmetric_eigenpairs)
 		RUN(test_utils, test_compute_column_means)
 		RUN(test_utils, test_remove_column_means)
 		RUN(test_utils, test_compute_column_rms)
@@ -32,6 +33,15 @@ struct test_utils : utils::mytestcase {
 		RUN(test_utils, test_get_mean)
 		RUN(test_utils, test_get_sigma)
 		RUN(test_utils, test_join)
+		RUN(test_utils, test_set_instruction_set)
+		RUN(test_utils, test_instruction_sets_agree)
+		RUN(test_utils, test_column_statistics_tall)
+		RUN(test_utils, test_covariance_matrix_tall)
+		RUN(test_utils, test_choose_solver)
+		RUN(test_utils, test_packed_covariance_matrix)
+		RUN(test_utils, test_eig_sym_packed)
+		RUN(test_utils, test_resize_placed)
+		RUN(test_utils, test_views)
 	}
 
     test_utils();
@@ -39,6 +49,7 @@ struct test_utils : utils::mytestcase {
 
 	void test_make_covariance_matrix();
 	void test_make_shuffled_matrix();
+	void test_refine_symmetric_eigenpairs();
 	void test_compute_column_means();
 	void test_remove_column_means();
 	void test_compute_column_rms();
@@ -59,6 +70,15 @@ struct test_utils : utils::mytestcase {
 	void test_get_mean();
 	void test_get_sigma();
 	void test_join();
+	void test_set_instruction_set();
+	void test_instruction_sets_agree();
+	void test_column_statistics_tall();
+	void test_covariance_matrix_tall();
+	void test_choose_solver();
+	void test_packed_covariance_matrix();
+	void test_eig_sym_packed();
+	void test_resize_placed();
+	void test_views();
 
 private:
     std::vector<std::string> tmp_files;
@@ -1,7 +1,21 @@
 #include "test_pca.h"
 #include "test_utils.h"
+#include "test_fixed_pca.h"
+#include "test_thread_pool.h"
+#include "test_pca_batch.h"
+#include "test_grouped_pca.h"
+#include "test_kernel_pca.h"
+#include "test_sparse_pca.h"
+#include "test_memory_resource.h"
 
 void unittest::run_all_tests() {
 	unittest::call<test_pca>();
 	unittest::call<test_utils>();
+	unittest::call<test_fixed_pca>();
+	unittest::call<test_thread_pool>();
+	unittest::call<test_pca_batch>();
+	unittest::call<test_grouped_pca>();
+	unittest::call<test_kernel_pca>();
+	unittest::call<test_sparse_pca>();
+	unittest::call<test_memory_resource>();
 }